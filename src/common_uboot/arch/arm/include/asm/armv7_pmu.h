@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * ARMv7-A Performance Monitors Unit (PMU) cycle counter access
+ *
+ * The cycle counter and its divider are shared by every user, so code which
+ * changes them for a measurement should put them back afterwards.
+ */
+
+#ifndef _ASM_ARMV7_PMU_H
+#define _ASM_ARMV7_PMU_H
+
+#include <linux/types.h>
+
+#define ARMV7_PMCR_E		(1 << 0)	/* Enable all counters */
+#define ARMV7_PMCR_C		(1 << 2)	/* Reset the cycle counter */
+#define ARMV7_PMCR_D		(1 << 3)	/* Count every 64th cycle */
+#define ARMV7_PMCNTEN_C		(1U << 31)	/* Cycle counter enable */
+#define ARMV7_PMOVSR_C		(1U << 31)	/* Cycle counter overflowed */
+
+/* Performance Monitors Control Register */
+static inline u32 armv7_pmu_get_pmcr(void)
+{
+	u32 pmcr;
+
+	asm volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+
+	return pmcr;
+}
+
+static inline void armv7_pmu_set_pmcr(u32 pmcr)
+{
+	asm volatile ("mcr p15, 0, %0, c9, c12, 0" : : "r" (pmcr));
+}
+
+/* Counters which are enabled (PMCNTENSET), ARMV7_PMCNTEN_... */
+static inline u32 armv7_pmu_get_enabled(void)
+{
+	u32 mask;
+
+	asm volatile ("mrc p15, 0, %0, c9, c12, 1" : "=r" (mask));
+
+	return mask;
+}
+
+static inline void armv7_pmu_enable(u32 mask)
+{
+	asm volatile ("mcr p15, 0, %0, c9, c12, 1" : : "r" (mask));
+}
+
+static inline void armv7_pmu_disable(u32 mask)
+{
+	asm volatile ("mcr p15, 0, %0, c9, c12, 2" : : "r" (mask));
+}
+
+/* Counters which have overflowed (PMOVSR), ARMV7_PMOVSR_... */
+static inline u32 armv7_pmu_get_overflow(void)
+{
+	u32 mask;
+
+	asm volatile ("mrc p15, 0, %0, c9, c12, 3" : "=r" (mask));
+
+	return mask;
+}
+
+static inline void armv7_pmu_clear_overflow(u32 mask)
+{
+	asm volatile ("mcr p15, 0, %0, c9, c12, 3" : : "r" (mask));
+}
+
+/* The cycle counter (PMCCNTR) */
+static inline u32 armv7_pmu_get_cycles(void)
+{
+	u32 cycles;
+
+	asm volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (cycles));
+
+	return cycles;
+}
+
+/* Set the cycle counter to zero */
+static inline void armv7_pmu_reset_cycles(void)
+{
+	armv7_pmu_set_pmcr(armv7_pmu_get_pmcr() | ARMV7_PMCR_C);
+}
+
+/**
+ * armv7_pmu_start_cycles() - start the cycle counter, counting every cycle
+ *
+ * @return the previous value of the PMCR, for armv7_pmu_set_pmcr()
+ */
+static inline u32 armv7_pmu_start_cycles(void)
+{
+	u32 pmcr = armv7_pmu_get_pmcr();
+
+	armv7_pmu_set_pmcr((pmcr | ARMV7_PMCR_E) & ~ARMV7_PMCR_D);
+	armv7_pmu_enable(ARMV7_PMCNTEN_C);
+
+	return pmcr;
+}
+
+#endif /* _ASM_ARMV7_PMU_H */
@@ -4,9 +4,10 @@
  */
 
 /*
- * Minimal semihosting implementation for reading files into memory. If more
- * features like writing files or console output are required they can be
- * added later. This code has been tested on arm64/aarch64 fastmodel only.
+ * Minimal semihosting implementation for reading files into memory and
+ * writing memory out to files. If more features like console output are
+ * required they can be added later. This code has been tested on
+ * arm64/aarch64 fastmodel only.
  * An untested placeholder exists for armv7 architectures, but since they
  * are commonly available in silicon now, fastmodel usage makes less sense
  * for them.
@@ -16,11 +17,13 @@
 
 #define SYSOPEN		0x01
 #define SYSCLOSE	0x02
+#define SYSWRITE	0x05
 #define SYSREAD		0x06
 #define SYSFLEN		0x0C
 
 #define MODE_READ	0x0
 #define MODE_READBIN	0x1
+#define MODE_WRITEBIN	0x5
 
 /*
  * Call the handler
@@ -40,7 +43,7 @@ static noinline long smh_trap(unsigned int sysnum, void *addr)
 }
 
 /*
- * Open a file on the host. Mode is "r" or "rb" currently. Returns a file
+ * Open a file on the host. Mode is "r", "rb" or "wb" currently. Returns a file
  * descriptor or -1 on error.
  */
 static long smh_open(const char *fname, char *modestr)
@@ -60,6 +63,8 @@ static long smh_open(const char *fname, char *modestr)
 		mode = MODE_READ;
 	} else if (!(strcmp(modestr, "rb"))) {
 		mode = MODE_READBIN;
+	} else if (!(strcmp(modestr, "wb"))) {
+		mode = MODE_WRITEBIN;
 	} else {
 		printf("%s: ERROR mode \'%s\' not supported\n", __func__,
 		       modestr);
@@ -113,6 +118,35 @@ static long smh_read(long fd, void *memp, size_t len)
 	return 0;
 }
 
+/*
+ * Write 'len' bytes from 'memp' to the file. Returns 0 on success, else failure
+ */
+static long smh_write(long fd, void *memp, size_t len)
+{
+	long ret;
+	struct smh_write_s {
+		long fd;
+		void *memp;
+		size_t len;
+	} write;
+
+	debug("%s: fd %ld, memp %p, len %zu\n", __func__, fd, memp, len);
+
+	write.fd = fd;
+	write.memp = memp;
+	write.len = len;
+
+	/* This returns the number of bytes which were not written */
+	ret = smh_trap(SYSWRITE, &write);
+	if (ret) {
+		printf("%s: ERROR ret %ld, fd %ld, len %zu memp %p\n",
+		       __func__, ret, fd, len, memp);
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * Close the file using the file descriptor
  */
@@ -213,3 +247,36 @@ U_BOOT_CMD(smhload, 4, 0, do_smhload, "load a file using semihosting",
 	   "      if the optional [end var] is specified, the end\n"
 	   "      address of the file will be stored in this environment\n"
 	   "      variable.\n");
+
+static int do_smhsave(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	ulong addr, size;
+	long fd;
+	long ret;
+
+	if (argc != 4)
+		return CMD_RET_USAGE;
+
+	addr = simple_strtoul(argv[2], NULL, 16);
+	size = simple_strtoul(argv[3], NULL, 16);
+
+	fd = smh_open(argv[1], "wb");
+	if (fd == -1)
+		return CMD_RET_FAILURE;
+
+	ret = smh_write(fd, (void *)addr, size);
+	smh_close(fd);
+	if (ret) {
+		printf("write failed\n");
+		return CMD_RET_FAILURE;
+	}
+	printf("saved %08lX bytes from %08lX to file %s\n", size, addr,
+	       argv[1]);
+
+	return 0;
+}
+
+U_BOOT_CMD(smhsave, 4, 0, do_smhsave, "save memory to a file using semihosting",
+	   "<file> 0x<address> 0x<size>\n"
+	   "    - write 'size' bytes of memory at 'address' to a file\n"
+	   "      on the host, replacing any existing file\n");
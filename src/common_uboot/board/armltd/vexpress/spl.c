@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SPL (Falcon mode) support for the Versatile Express CA9x4.
+ *
+ * SPL loads the payload named by CONFIG_SPL_FS_LOAD_KERNEL_NAME from the
+ * first partition of the SD card and jumps straight into it. The full
+ * U-Boot (u-boot.img on the same partition) is only started when recovery
+ * is requested, see spl_start_uboot() below.
+ */
+#include <common.h>
+#include <spl.h>
+#include <asm/io.h>
+
+/* User switch on the motherboard that requests U-Boot instead of the OS */
+#define VEXPRESS_SYS_SW_RECOVERY	(1 << 0)
+
+void vexpress_timer_init(void);
+
+u32 spl_boot_device(void)
+{
+	return BOOT_DEVICE_MMC1;
+}
+
+int timer_init(void)
+{
+	/* The MMC driver relies on udelay() and get_timer() */
+	vexpress_timer_init();
+
+	return 0;
+}
+
+void spl_board_init(void)
+{
+	preloader_console_init();
+}
+
+#ifdef CONFIG_SPL_OS_BOOT
+/*
+ * Start the full U-Boot if a key is held down on the console while SPL
+ * runs, or if user switch 0 on the motherboard is set. Otherwise boot the
+ * OS payload directly. The loaders may ask more than once, so the first
+ * answer is remembered (the key press is consumed when it is seen).
+ */
+int spl_start_uboot(void)
+{
+	static int start_uboot = -1;
+
+	if (start_uboot >= 0)
+		return start_uboot;
+
+	start_uboot = 0;
+	if (serial_tstc()) {
+		serial_getc();
+		puts("SPL: recovery key pressed, starting U-Boot\n");
+		start_uboot = 1;
+	} else if (readl(V2M_SYS_SW) & VEXPRESS_SYS_SW_RECOVERY) {
+		puts("SPL: recovery switch set, starting U-Boot\n");
+		start_uboot = 1;
+	}
+
+	return start_uboot;
+}
+#endif
@@ -24,13 +24,14 @@
 #include <asm/arch/systimer.h>
 #include <asm/arch/sysctrl.h>
 #include <asm/arch/wdt.h>
+#include <linux/sizes.h>
 #include "../drivers/mmc/arm_pl180_mmci.h"
 
 static struct systimer *systimer_base = (struct systimer *)V2M_TIMER01;
 static struct sysctrl *sysctrl_base = (struct sysctrl *)SCTL_BASE;
 
 static void flash__init(void);
-static void vexpress_timer_init(void);
+void vexpress_timer_init(void);
 DECLARE_GLOBAL_DATA_PTR;
 
 #if defined(CONFIG_SHOW_BOOT_PROGRESS)
@@ -47,15 +48,29 @@ static inline void delay(ulong loops)
 		"bne 1b" : "=r" (loops) : "0" (loops));
 }
 
+/* Collect iotrace statistics for the peripherals used by U-Boot */
+static void vexpress_iotrace_init(void)
+{
+#ifdef CONFIG_IO_TRACE
+	iotrace_add_window("mmci", V2M_MMCI, SZ_4K);
+	iotrace_add_window("uart0", V2M_UART0, SZ_4K);
+#ifdef CONFIG_SMC911X
+	iotrace_add_window("smc911x", CONFIG_SMC911X_BASE, SZ_64K);
+#endif
+	iotrace_add_window("flash0", CONFIG_SYS_FLASH_BASE0, PHYS_FLASH_SIZE);
+	iotrace_add_window("flash1", CONFIG_SYS_FLASH_BASE1, PHYS_FLASH_SIZE);
+#endif
+}
+
 int board_init(void)
 {
 	gd->bd->bi_boot_params = LINUX_BOOT_PARAM_ADDR;
 	gd->bd->bi_arch_number = MACH_TYPE_VEXPRESS;
-	gd->flags = 0;
 
 	icache_enable();
 	flash__init();
 	vexpress_timer_init();
+	vexpress_iotrace_init();
 
 	return 0;
 }
@@ -127,7 +142,7 @@ int dram_init_banksize(void)
  *    Setup a 32 bit timer, running at 1KHz
  *    Versatile Express Motherboard provides 1 MHz timer
  */
-static void vexpress_timer_init(void)
+void vexpress_timer_init(void)
 {
 	/*
 	 * Set clock frequency in system controller:
@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decompression benchmark
+ *
+ * Decompresses the same payload stored in several formats (gzip, bzip2,
+ * LZMA, LZO, LZ4, or none for a plain copy), checks each result against
+ * the uncompressed payload and reports the speed in MiB/s of output and,
+ * where the CPU has a cycle counter, in CPU cycles per output byte. This
+ * shows which format gives the shortest load-and-decompress time for a
+ * given kernel or ramdisk on a given board.
+ */
+
+#include <common.h>
+#include <bzlib.h>
+#include <command.h>
+#include <console.h>
+#include <div64.h>
+#include <image.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+#include <lzma/LzmaTools.h>
+#include <linux/lzo.h>
+#ifdef CONFIG_CPU_V7A
+#include <asm/armv7_pmu.h>
+#endif
+
+/* Each format is decompressed for at least this long (or this many times) */
+#define COMPBENCH_MIN_US	1000000
+#define COMPBENCH_MAX_RUNS	100
+
+/*
+ * The Cortex-A cycle counter is 32 bits and is run undivided, so that it
+ * agrees with iotrace. It is reset before each run and the runs are added
+ * up in 64 bits; a run long enough to overflow it gives no cycle count.
+ * The PMU settings are put back afterwards.
+ */
+#ifdef CONFIG_CPU_V7A
+#define COMPBENCH_CYCLES	true
+
+static u32 compbench_pmcr;
+static u32 compbench_pmcnten;
+
+static void compbench_cycles_init(void)
+{
+	compbench_pmcnten = armv7_pmu_get_enabled();
+	compbench_pmcr = armv7_pmu_start_cycles();
+}
+
+static void compbench_cycles_done(void)
+{
+	armv7_pmu_set_pmcr(compbench_pmcr);
+	if (!(compbench_pmcnten & ARMV7_PMCNTEN_C))
+		armv7_pmu_disable(ARMV7_PMCNTEN_C);
+}
+
+static void compbench_cycles_reset(void)
+{
+	armv7_pmu_clear_overflow(ARMV7_PMOVSR_C);
+	armv7_pmu_reset_cycles();
+}
+
+/* Returns false if the counter overflowed since compbench_cycles_reset() */
+static bool compbench_cycles(u32 *countp)
+{
+	*countp = armv7_pmu_get_cycles();
+
+	return !(armv7_pmu_get_overflow() & ARMV7_PMOVSR_C);
+}
+#else
+#define COMPBENCH_CYCLES	false
+
+static void compbench_cycles_init(void)
+{
+}
+
+static void compbench_cycles_done(void)
+{
+}
+
+static void compbench_cycles_reset(void)
+{
+}
+
+static bool compbench_cycles(u32 *countp)
+{
+	*countp = 0;
+
+	return false;
+}
+#endif
+
+/**
+ * struct compbench_result - results for one format
+ *
+ * @comp:	Compression type (IH_COMP_...)
+ * @in_len:	Size of the compressed payload in bytes
+ * @runs:	Number of times it was decompressed
+ * @mibps:	Speed in MiB/s of decompressed output
+ * @cpb_x10:	CPU cycles per output byte, times 10 (0 if unknown)
+ */
+struct compbench_result {
+	int comp;
+	ulong in_len;
+	ulong runs;
+	ulong mibps;
+	ulong cpb_x10;
+};
+
+/**
+ * compbench_decomp() - decompress a buffer
+ *
+ * @comp:	Compression type (IH_COMP_...)
+ * @dst:	Output buffer
+ * @dst_len:	Size of the output buffer
+ * @src:	Compressed data
+ * @src_len:	Size of the compressed data
+ * @lenp:	Returns the number of bytes written to @dst
+ * @return 0 if OK, -ENOSYS if the format is not supported in this build,
+ * other -ve value on error
+ */
+static int compbench_decomp(int comp, void *dst, ulong dst_len, void *src,
+			    ulong src_len, ulong *lenp)
+{
+	int ret;
+
+	switch (comp) {
+	case IH_COMP_NONE:
+		if (src_len > dst_len)
+			return -ENOSPC;
+		memcpy(dst, src, src_len);
+		*lenp = src_len;
+		return 0;
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP: {
+		unsigned long len = src_len;
+
+		ret = gunzip(dst, dst_len, src, &len);
+		*lenp = len;
+		break;
+	}
+#endif
+#ifdef CONFIG_BZIP2
+	case IH_COMP_BZIP2: {
+		uint len = dst_len;
+
+		ret = BZ2_bzBuffToBuffDecompress(dst, &len, src, src_len,
+				CONFIG_SYS_MALLOC_LEN < (4096 * 1024), 0);
+		*lenp = len;
+		break;
+	}
+#endif
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA: {
+		SizeT len = dst_len;
+
+		ret = lzmaBuffToBuffDecompress(dst, &len, src, src_len);
+		*lenp = len;
+		break;
+	}
+#endif
+#ifdef CONFIG_LZO
+	case IH_COMP_LZO: {
+		size_t len = dst_len;
+
+		ret = lzop_decompress(src, src_len, dst, &len);
+		*lenp = len;
+		break;
+	}
+#endif
+#ifdef CONFIG_LZ4
+	case IH_COMP_LZ4: {
+		size_t len = dst_len;
+
+		ret = ulz4fn(src, src_len, dst, &len);
+		*lenp = len;
+		break;
+	}
+#endif
+	default:
+		return -ENOSYS;
+	}
+
+	return ret ? -EIO : 0;
+}
+
+/**
+ * compbench_run() - decompress one payload repeatedly and time it
+ *
+ * Each run starts with the caches cleaned, much as after the payload has
+ * been loaded from storage. The first run's output is checked against
+ * @ref; the later ones are only timed.
+ *
+ * @res:	Returns the results; @res->comp and @res->in_len must be set
+ * @src:	Compressed payload
+ * @dst:	Output buffer, @ref_len bytes
+ * @ref:	Expected output
+ * @ref_len:	Size of the expected output
+ * @return 0 if OK, -ve on error
+ */
+static int compbench_run(struct compbench_result *res, void *src, void *dst,
+			 const void *ref, ulong ref_len)
+{
+	bool have_cycles = COMPBENCH_CYCLES;
+	u64 cycles = 0;
+	ulong total_us = 0;
+	ulong len;
+	int ret;
+
+	for (res->runs = 0; res->runs < COMPBENCH_MAX_RUNS &&
+	     total_us < COMPBENCH_MIN_US; res->runs++) {
+		ulong start;
+		u32 count;
+
+		flush_dcache_all();
+		compbench_cycles_reset();
+		start = timer_get_us();
+		ret = compbench_decomp(res->comp, dst, ref_len, src,
+				       res->in_len, &len);
+		total_us += timer_get_us() - start;
+		if (!compbench_cycles(&count))
+			have_cycles = false;
+		cycles += count;
+		if (ret)
+			return ret;
+
+		if (!res->runs && (len != ref_len || memcmp(dst, ref, len))) {
+			printf("%s: output does not match (%lu bytes, expected %lu)\n",
+			       genimg_get_comp_short_name(res->comp), len,
+			       ref_len);
+			return -EINVAL;
+		}
+	}
+
+	res->mibps = lldiv((u64)ref_len * res->runs * 1000000,
+			   max_t(ulong, total_us, 1)) >> 20;
+	res->cpb_x10 = have_cycles ? lldiv(cycles * 10,
+					   (u64)ref_len * res->runs) : 0;
+
+	return 0;
+}
+
+static int do_compbench(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	struct compbench_result *res;
+	ulong dst_addr, ref_addr, ref_len;
+	void *dst, *ref;
+	int count, i;
+	int ret = CMD_RET_SUCCESS;
+
+	if (argc < 7 || (argc - 4) % 3)
+		return CMD_RET_USAGE;
+	dst_addr = simple_strtoul(argv[1], NULL, 16);
+	ref_addr = simple_strtoul(argv[2], NULL, 16);
+	ref_len = simple_strtoul(argv[3], NULL, 16);
+	if (!ref_len)
+		return CMD_RET_USAGE;
+
+	count = (argc - 4) / 3;
+	res = calloc(count, sizeof(*res));
+	if (!res) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+	for (i = 0; i < count; i++) {
+		const char *name = argv[4 + i * 3];
+
+		res[i].comp = genimg_get_comp_id(name);
+		if (res[i].comp < 0) {
+			printf("Unknown compression type '%s'\n", name);
+			free(res);
+			return CMD_RET_USAGE;
+		}
+	}
+
+	compbench_cycles_init();
+	dst = map_sysmem(dst_addr, ref_len);
+	ref = map_sysmem(ref_addr, ref_len);
+	puts("Format      Input bytes    Ratio   Runs    MiB/s   Cycles/byte\n");
+	for (i = 0; i < count; i++) {
+		struct compbench_result *r = &res[i];
+		ulong src_addr = simple_strtoul(argv[5 + i * 3], NULL, 16);
+		void *src;
+		int err;
+
+		if (ctrlc()) {
+			count = i;
+			break;
+		}
+		r->in_len = simple_strtoul(argv[6 + i * 3], NULL, 16);
+		src = map_sysmem(src_addr, r->in_len);
+		err = compbench_run(r, src, dst, ref, ref_len);
+		unmap_sysmem(src);
+		if (err) {
+			if (err == -ENOSYS)
+				printf("%-8s not enabled in this build\n",
+				       genimg_get_comp_short_name(r->comp));
+			else
+				printf("%-8s failed (err=%d)\n",
+				       genimg_get_comp_short_name(r->comp),
+				       err);
+			r->runs = 0;
+			ret = CMD_RET_FAILURE;
+			continue;
+		}
+
+		printf("%-8s %14lu %7lu%% %6lu %8lu",
+		       genimg_get_comp_short_name(r->comp), r->in_len,
+		       (ulong)lldiv((u64)r->in_len * 100, ref_len), r->runs,
+		       r->mibps);
+		if (r->cpb_x10)
+			printf(" %11lu.%lu\n", r->cpb_x10 / 10, r->cpb_x10 % 10);
+		else
+			printf(" %13s\n", "-");
+	}
+	compbench_cycles_done();
+	unmap_sysmem(ref);
+	unmap_sysmem(dst);
+
+	/* One line per format which scripts can pick up */
+	for (i = 0; i < count; i++) {
+		struct compbench_result *r = &res[i];
+
+		if (!r->runs)
+			continue;
+		printf("compbench: comp=%s in=%lu out=%lu mibps=%lu cpb_x10=%lu\n",
+		       genimg_get_comp_short_name(r->comp), r->in_len, ref_len,
+		       r->mibps, r->cpb_x10);
+	}
+	free(res);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	compbench,	CONFIG_SYS_MAXARGS,	0,	do_compbench,
+	"decompression speed benchmark",
+	"dst ref ref_len comp src src_len [comp src src_len ...]\n"
+	"    - decompress each 'src_len' bytes at 'src', in format 'comp'\n"
+	"      (none, gzip, bzip2, lzma, lzo or lz4), to 'dst', check the\n"
+	"      result against the 'ref_len' bytes at 'ref' and report the\n"
+	"      speed. The memory at 'dst' is overwritten."
+);
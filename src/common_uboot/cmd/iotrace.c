@@ -5,8 +5,15 @@
 
 #include <common.h>
 #include <command.h>
+#include <div64.h>
 #include <iotrace.h>
 
+#ifdef CONFIG_IO_TRACE_CYCLE_COUNTER
+#define TICK_UNIT	"cycles"
+#else
+#define TICK_UNIT	"timer ticks"
+#endif
+
 static void do_print_stats(void)
 {
 	ulong start, size, needed_size, offset, count;
@@ -36,20 +43,22 @@ static void do_print_trace(void)
 	if (!start || !size || !count)
 		return;
 
-	printf("Timestamp  Value          Address\n");
+	printf("Timestamp  Value          Address     Latency\n");
 
 	cur_record = (struct iotrace_record *)start;
 	for (int i = 0; i < count; i++) {
 		if (cur_record->flags & IOT_WRITE)
-			printf("%08llu: 0x%08lx --> 0x%08llx\n",
+			printf("%08llu: 0x%08lx --> 0x%08llx %8u\n",
 			       cur_record->timestamp,
 					cur_record->value,
-					(unsigned long long)cur_record->addr);
+					(unsigned long long)cur_record->addr,
+					cur_record->latency);
 		else
-			printf("%08llu: 0x%08lx <-- 0x%08llx\n",
+			printf("%08llu: 0x%08lx <-- 0x%08llx %8u\n",
 			       cur_record->timestamp,
 					cur_record->value,
-					(unsigned long long)cur_record->addr);
+					(unsigned long long)cur_record->addr,
+					cur_record->latency);
 
 		cur_record++;
 	}
@@ -87,6 +96,72 @@ static int do_set_region(int argc, char * const argv[])
 	return 0;
 }
 
+static void do_print_windows(void)
+{
+	const struct iotrace_window *win;
+	int i;
+
+	printf("Times in %s\n", TICK_UNIT);
+	printf("Window            Reads    Writes       Total  Avg    Max     Polls  Longest poll\n");
+	for (i = 0; (win = iotrace_get_window(i)); i++) {
+		ulong count = win->reads + win->writes;
+
+		printf("%-15s %7lu %9lu %11llu %4llu %6lu %9lu",
+		       win->name, win->reads, win->writes, win->ticks,
+		       count ? lldiv(win->ticks, count) : 0, win->max_ticks,
+		       win->polls);
+		if (win->max_poll_run)
+			printf("  %lu at %08lx", win->max_poll_run,
+			       win->max_poll_addr);
+		printf("\n");
+	}
+}
+
+static void do_print_hist(void)
+{
+	const struct iotrace_window *win;
+	int i, j;
+
+	for (i = 0; (win = iotrace_get_window(i)); i++) {
+		printf("%s (%08lx, size %lx), latency in %s:\n", win->name,
+		       win->start, win->size, TICK_UNIT);
+		for (j = 0; j < IOTRACE_HIST_BUCKETS; j++) {
+			if (!win->hist[j])
+				continue;
+			if (!j)
+				printf("%19s", "0");
+			else if (j == IOTRACE_HIST_BUCKETS - 1)
+				printf("%10lu or more", 1UL << (j - 1));
+			else
+				printf("%8lu - %8lu", 1UL << (j - 1),
+				       (1UL << j) - 1);
+			printf(": %lu\n", win->hist[j]);
+		}
+	}
+}
+
+static int do_set_window(int argc, char * const argv[])
+{
+	ulong addr, size;
+	int ret;
+
+	if (argc == 0) {
+		do_print_windows();
+		return 0;
+	}
+	if (argc != 3)
+		return CMD_RET_USAGE;
+	addr = simple_strtoul(argv[1], NULL, 16);
+	size = simple_strtoul(argv[2], NULL, 16);
+	ret = iotrace_add_window(argv[0], addr, size);
+	if (ret < 0) {
+		printf("Cannot add window (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 int do_iotrace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
@@ -110,6 +185,14 @@ int do_iotrace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	case 'd':
 		do_print_trace();
 		break;
+	case 'w':
+		return do_set_window(argc - 2, argv + 2);
+	case 'h':
+		do_print_hist();
+		break;
+	case 'c':
+		iotrace_reset_stats();
+		break;
 	default:
 		return CMD_RET_USAGE;
 	}
@@ -118,12 +201,16 @@ int do_iotrace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 }
 
 U_BOOT_CMD(
-	iotrace,	4,	1,	do_iotrace,
+	iotrace,	5,	1,	do_iotrace,
 	"iotrace utility commands",
 	"stats                        - display iotrace stats\n"
 	"iotrace buffer <address> <size>      - set iotrace buffer\n"
 	"iotrace limit <address> <size>       - set iotrace region limit\n"
 	"iotrace pause                        - pause tracing\n"
 	"iotrace resume                       - resume tracing\n"
-	"iotrace dump                         - dump iotrace buffer"
+	"iotrace dump                         - dump iotrace buffer\n"
+	"iotrace window                       - display window statistics\n"
+	"iotrace window <name> <address> <size> - add a statistics window\n"
+	"iotrace hist                         - display latency histograms\n"
+	"iotrace clear                        - clear window statistics"
 );
@@ -16,9 +16,11 @@
 #include <cli.h>
 #include <command.h>
 #include <console.h>
+#include <div64.h>
 #include <hash.h>
 #include <inttypes.h>
 #include <mapmem.h>
+#include <memalign.h>
 #include <watchdog.h>
 #include <asm/io.h>
 #include <linux/compiler.h>
@@ -851,10 +853,170 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+/* Words handled together by the block test (16 bytes, like an LDM/STM) */
+#define MEMTEST_BLOCK_WORDS	4
+
+/* Number of words between watchdog resets and ctrl-c checks */
+#define MEMTEST_BLOCK_CHUNK	(64 * 1024)
+
+/*
+ * Make sure the pattern has reached memory and is not just sitting in the
+ * data cache, so that the next pass reads it back from memory.
+ */
+static void mem_test_block_flush(ulong *buf, ulong *end)
+{
+	if (dcache_status())
+		flush_dcache_range(rounddown((ulong)buf, ARCH_DMA_MINALIGN),
+				   roundup((ulong)end, ARCH_DMA_MINALIGN));
+}
+
+/* Report any mismatches in @count words, returns the number found */
+static ulong mem_test_block_report(ulong *buf, ulong *addr, int count,
+				   ulong start_addr, ulong val, ulong incr)
+{
+	ulong errs = 0;
+	int i;
+
+	for (i = 0; i < count; i++, val += incr) {
+		if (addr[i] == val)
+			continue;
+		printf("\nMem error @ 0x%08X: found %08lX, expected %08lX\n",
+		       (uint)(uintptr_t)(start_addr +
+					 (addr + i - buf) * sizeof(ulong)),
+		       addr[i], val);
+		errs++;
+	}
+
+	return errs;
+}
+
+/*
+ * This uses the same incrementing pattern as mem_test_quick(), but handles
+ * a block of words at a time with ordinary (not volatile) accesses, so the
+ * compiler can use multiple-word loads and stores. Each location is checked
+ * holding the pattern and then its complement, so every bit is tested as a
+ * zero and a one. The data cache is flushed after each write pass, so that
+ * the checks read back what is in memory rather than what is in the cache.
+ * Any words after the last whole block are handled one at a time.
+ */
+static ulong mem_test_block(vu_long *vbuf, ulong start_addr, ulong end_addr,
+			    ulong pattern, int iteration)
+{
+	ulong *buf = (ulong *)vbuf;
+	ulong *addr, *end, *last;
+	ulong errs = 0;
+	ulong incr, step, val;
+	ulong length;
+	int i;
+
+	/* Alternate the pattern, as mem_test_quick() does */
+	incr = 1;
+	if (iteration & 1) {
+		incr = -incr;
+		if (pattern & 0x80000000)
+			pattern = -pattern;	/* complement & increment */
+		else
+			pattern = ~pattern;
+	}
+	step = incr * MEMTEST_BLOCK_WORDS;
+	length = (end_addr - start_addr) / sizeof(ulong);
+	last = buf + length;
+	end = buf + (length & ~(MEMTEST_BLOCK_WORDS - 1));
+	printf("\rPattern %08lX  Writing..."
+		"%12s"
+		"\b\b\b\b\b\b\b\b\b\b",
+		pattern, "");
+
+	for (addr = buf, val = pattern; addr < end;
+	     addr += MEMTEST_BLOCK_WORDS, val += step) {
+		if (!((addr - buf) % MEMTEST_BLOCK_CHUNK))
+			WATCHDOG_RESET();
+		addr[0] = val;
+		addr[1] = val + incr;
+		addr[2] = val + 2 * incr;
+		addr[3] = val + 3 * incr;
+	}
+	for (i = 0; addr < last; addr++, i++)
+		*addr = val + i * incr;
+	mem_test_block_flush(buf, last);
+
+	puts("Reading...");
+
+	/* Check the pattern and replace it with its complement */
+	for (addr = buf, val = pattern; addr < end;
+	     addr += MEMTEST_BLOCK_WORDS, val += step) {
+		if (!((addr - buf) % MEMTEST_BLOCK_CHUNK)) {
+			WATCHDOG_RESET();
+			if (errs && ctrlc())
+				return -1;
+		}
+		if (addr[0] != val || addr[1] != val + incr ||
+		    addr[2] != val + 2 * incr || addr[3] != val + 3 * incr)
+			errs += mem_test_block_report(buf, addr,
+						      MEMTEST_BLOCK_WORDS,
+						      start_addr, val, incr);
+		addr[0] = ~val;
+		addr[1] = ~(val + incr);
+		addr[2] = ~(val + 2 * incr);
+		addr[3] = ~(val + 3 * incr);
+	}
+	for (; addr < last; addr++, val += incr) {
+		errs += mem_test_block_report(buf, addr, 1, start_addr, val,
+					      incr);
+		*addr = ~val;
+	}
+	mem_test_block_flush(buf, last);
+
+	/* Check the complement (~val decreases as val increases) */
+	for (addr = buf, val = ~pattern; addr < end;
+	     addr += MEMTEST_BLOCK_WORDS, val -= step) {
+		if (!((addr - buf) % MEMTEST_BLOCK_CHUNK)) {
+			WATCHDOG_RESET();
+			if (errs && ctrlc())
+				return -1;
+		}
+		if (addr[0] != val || addr[1] != val - incr ||
+		    addr[2] != val - 2 * incr || addr[3] != val - 3 * incr)
+			errs += mem_test_block_report(buf, addr,
+						      MEMTEST_BLOCK_WORDS,
+						      start_addr, val, -incr);
+	}
+	if (addr < last)
+		errs += mem_test_block_report(buf, addr, last - addr,
+					      start_addr, val, -incr);
+
+	return errs;
+}
+
+/**
+ * struct mem_test_algo - a memory test which mtest can run
+ *
+ * @name:	Name used to select the test with 'mtest -t'
+ * @passes:	Number of times each iteration reads or writes the whole
+ *		range, used to work out the bandwidth (0 if not meaningful)
+ */
+struct mem_test_algo {
+	const char *name;
+	int passes;
+};
+
+enum {
+	MEMTEST_QUICK,
+	MEMTEST_ALT,
+	MEMTEST_BLOCK,
+};
+
+static const struct mem_test_algo mem_test_algos[] = {
+	[MEMTEST_QUICK]	= { "quick", 2 },
+	[MEMTEST_ALT]	= { "alt", 0 },
+	[MEMTEST_BLOCK]	= { "block", 4 },
+};
+
 /*
  * Perform a memory test. A more complete alternative test can be
- * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
- * interrupted by ctrl-c or by a failure of one of the sub-tests.
+ * configured using CONFIG_SYS_ALT_MEMTEST, and any of the tests can be
+ * selected with '-t'. The complete test loops until interrupted by ctrl-c
+ * or by a failure of one of the sub-tests.
  */
 static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 			char * const argv[])
@@ -865,13 +1027,27 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 	int ret;
 	ulong errs = 0;	/* number of errors, or -1 if interrupted */
 	ulong pattern = 0;
+	ulong start_ms, elapsed_ms;
 	int iteration;
 #if defined(CONFIG_SYS_ALT_MEMTEST)
-	const int alt_test = 1;
+	int algo = MEMTEST_ALT;
 #else
-	const int alt_test = 0;
+	int algo = MEMTEST_QUICK;
 #endif
 
+	if (argc > 2 && !strcmp(argv[1], "-t")) {
+		for (algo = 0; algo < ARRAY_SIZE(mem_test_algos); algo++) {
+			if (!strcmp(argv[2], mem_test_algos[algo].name))
+				break;
+		}
+		if (algo == ARRAY_SIZE(mem_test_algos)) {
+			printf("Unknown test '%s'\n", argv[2]);
+			return CMD_RET_USAGE;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+
 	start = CONFIG_SYS_MEMTEST_START;
 	end = CONFIG_SYS_MEMTEST_END;
 
@@ -902,6 +1078,7 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 
 	buf = map_sysmem(start, end - start);
 	dummy = map_sysmem(CONFIG_SYS_MEMTEST_SCRATCH, sizeof(vu_long));
+	start_ms = get_timer(0);
 	for (iteration = 0;
 			!iteration_limit || iteration < iteration_limit;
 			iteration++) {
@@ -912,15 +1089,23 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
-		if (alt_test) {
+		switch (algo) {
+		case MEMTEST_ALT:
 			errs = mem_test_alt(buf, start, end, dummy);
-		} else {
+			break;
+		case MEMTEST_BLOCK:
+			errs = mem_test_block(buf, start, end, pattern,
+					      iteration);
+			break;
+		default:
 			errs = mem_test_quick(buf, start, end, pattern,
 					      iteration);
+			break;
 		}
 		if (errs == -1UL)
 			break;
 	}
+	elapsed_ms = get_timer(start_ms);
 
 	/*
 	 * Work-around for eldk-4.2 which gives this warning if we try to
@@ -942,6 +1127,14 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 	} else {
 		printf("Tested %d iteration(s) with %lu errors.\n",
 			iteration, errs);
+		if (mem_test_algos[algo].passes && elapsed_ms) {
+			u64 bytes = (u64)(end - start) * iteration *
+				mem_test_algos[algo].passes;
+
+			printf("%s test: %lu ms, %lu MiB/s\n",
+			       mem_test_algos[algo].name, elapsed_ms,
+			       (ulong)(lldiv(bytes * 1000, elapsed_ms) >> 20));
+		}
 		ret = errs != 0;
 	}
 
@@ -1217,9 +1410,11 @@ U_BOOT_CMD(
 
 #ifdef CONFIG_CMD_MEMTEST
 U_BOOT_CMD(
-	mtest,	5,	1,	do_mem_mtest,
+	mtest,	7,	1,	do_mem_mtest,
 	"simple RAM read/write test",
-	"[start [end [pattern [iterations]]]]"
+	"[-t test] [start [end [pattern [iterations]]]]\n"
+	"    - test is 'quick', 'alt' or 'block' (default depends on the\n"
+	"      configuration)"
 );
 #endif	/* CONFIG_CMD_MEMTEST */
 
@@ -0,0 +1,306 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Memory bandwidth and latency benchmark
+ *
+ * Measures copy (memcpy), fill (memset) and read bandwidth, and the latency
+ * of dependent loads (a pointer chase in random order), for buffer sizes
+ * from a few KiB, which fit in the L1 cache, up to several MiB, which do
+ * not fit in any cache. On ARM, memcpy() and memset() are the assembler
+ * versions in arch/arm/lib when CONFIG_USE_ARCH_MEMCPY/MEMSET are enabled.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <div64.h>
+#include <mapmem.h>
+#include <memalign.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Smallest buffer size tested, and the factor between sizes */
+#define MEMBENCH_MIN_SIZE	SZ_4K
+#define MEMBENCH_SIZE_SHIFT	2
+
+/* Default for the largest buffer size; copying uses twice this */
+#define MEMBENCH_DEFAULT_SIZE	SZ_16M
+
+/* Each measurement moves at least this much data (or makes these loads) */
+#define MEMBENCH_MIN_BYTES	SZ_64M
+#define MEMBENCH_MIN_LOADS	(4 * 1024 * 1024)
+
+/* Distance between the elements of the pointer chase */
+#define MEMBENCH_CHASE_STRIDE	ARCH_DMA_MINALIGN
+
+/* Room left for the stack to grow below its current position */
+#define MEMBENCH_STACK_MARGIN	SZ_16K
+
+/**
+ * struct membench_result - results for one buffer size
+ *
+ * @size:	Buffer size in bytes
+ * @copy:	Copy bandwidth in MiB/s (bytes copied, not bytes moved)
+ * @fill:	Fill bandwidth in MiB/s
+ * @read:	Read bandwidth in MiB/s
+ * @latency_ps:	Time for one dependent load, in picoseconds
+ */
+struct membench_result {
+	ulong size;
+	ulong copy;
+	ulong fill;
+	ulong read;
+	ulong latency_ps;
+};
+
+static ulong membench_mibps(u64 bytes, ulong us)
+{
+	if (!us)
+		us = 1;
+
+	return lldiv(bytes * 1000000, us) >> 20;
+}
+
+/* Number of passes over @size bytes needed for a stable measurement */
+static ulong membench_loops(ulong size)
+{
+	return max_t(ulong, 1, MEMBENCH_MIN_BYTES / size);
+}
+
+/* Start from a clean cache, then touch the buffer once so it is warm */
+static void membench_prepare(void *buf, ulong size)
+{
+	flush_dcache_all();
+	memset(buf, '\0', size);
+}
+
+static ulong membench_copy(void *dst, void *src, ulong size)
+{
+	ulong loops = membench_loops(size);
+	ulong start, i;
+
+	membench_prepare(src, size);
+	memcpy(dst, src, size);
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		memcpy(dst, src, size);
+
+	return membench_mibps((u64)size * loops, timer_get_us() - start);
+}
+
+static ulong membench_fill(void *buf, ulong size)
+{
+	ulong loops = membench_loops(size);
+	ulong start, i;
+
+	membench_prepare(buf, size);
+	start = timer_get_us();
+	for (i = 0; i < loops; i++)
+		memset(buf, i, size);
+
+	return membench_mibps((u64)size * loops, timer_get_us() - start);
+}
+
+static ulong membench_read(void *buf, ulong size)
+{
+	ulong loops = membench_loops(size);
+	ulong words = size / sizeof(ulong);
+	volatile ulong sink;
+	ulong start, i;
+
+	membench_prepare(buf, size);
+	start = timer_get_us();
+	for (i = 0; i < loops; i++) {
+		const ulong *p = buf, *end = p + words;
+		ulong sum = 0;
+
+		/* Several independent loads per step keep the memory busy */
+		for (; p < end; p += 8)
+			sum += p[0] ^ p[1] ^ p[2] ^ p[3] ^
+				p[4] ^ p[5] ^ p[6] ^ p[7];
+		sink = sum;
+	}
+	(void)sink;
+
+	return membench_mibps((u64)size * loops, timer_get_us() - start);
+}
+
+/*
+ * Link the elements of the buffer into a single cycle in random order, so
+ * that each load depends on the previous one and the prefetcher cannot
+ * guess the next address. @scratch holds the order while it is worked out.
+ * Returns the first element.
+ */
+static void **membench_chase_setup(void *buf, ulong size, ulong *scratch)
+{
+	ulong count = size / MEMBENCH_CHASE_STRIDE;
+	ulong i, seed = 1;
+
+	for (i = 0; i < count; i++)
+		scratch[i] = i;
+	for (i = count - 1; i > 0; i--) {
+		ulong j, tmp;
+
+		seed = seed * 1103515245 + 12345;
+		j = (seed >> 8) % (i + 1);
+		tmp = scratch[i];
+		scratch[i] = scratch[j];
+		scratch[j] = tmp;
+	}
+	for (i = 0; i < count; i++) {
+		void **elem = buf + scratch[i] * MEMBENCH_CHASE_STRIDE;
+
+		*elem = buf + scratch[(i + 1) % count] * MEMBENCH_CHASE_STRIDE;
+	}
+
+	return buf + scratch[0] * MEMBENCH_CHASE_STRIDE;
+}
+
+static ulong membench_latency(void *buf, ulong size, void *scratch)
+{
+	ulong loads = max_t(ulong, MEMBENCH_MIN_LOADS,
+			    size / MEMBENCH_CHASE_STRIDE);
+	void **p;
+	ulong start, us, i;
+
+	if (size < 2 * MEMBENCH_CHASE_STRIDE)
+		return 0;
+	p = membench_chase_setup(buf, size, scratch);
+	flush_dcache_all();
+	start = timer_get_us();
+	for (i = 0; i < loads; i++)
+		p = *p;
+	us = timer_get_us() - start;
+	/* Keep the compiler from dropping the loop */
+	if (!p)
+		return 0;
+
+	return lldiv((u64)us * 1000000, loads);
+}
+
+/* Ctrl-C is only checked between sizes, since that is where time is spent */
+static int membench_run(void *buf, ulong max_size)
+{
+	struct membench_result *res;
+	int count = 0, i;
+	ulong size;
+
+	for (size = MEMBENCH_MIN_SIZE; size <= max_size;
+	     size <<= MEMBENCH_SIZE_SHIFT)
+		count++;
+	res = calloc(count, sizeof(*res));
+	if (!res)
+		return -ENOMEM;
+
+	puts("    Size   Copy MiB/s   Fill MiB/s   Read MiB/s   Latency ns\n");
+	for (i = 0, size = MEMBENCH_MIN_SIZE; i < count;
+	     i++, size <<= MEMBENCH_SIZE_SHIFT) {
+		struct membench_result *r = &res[i];
+
+		if (ctrlc()) {
+			count = i;
+			break;
+		}
+		r->size = size;
+		r->copy = membench_copy(buf + max_size, buf, size);
+		r->fill = membench_fill(buf, size);
+		r->read = membench_read(buf, size);
+		r->latency_ps = membench_latency(buf, size, buf + max_size);
+		printf("%6lu%s %12lu %12lu %12lu %8lu.%03lu\n",
+		       size >= SZ_1M ? size >> 20 : size >> 10,
+		       size >= SZ_1M ? "M" : "K", r->copy, r->fill, r->read,
+		       r->latency_ps / 1000, r->latency_ps % 1000);
+	}
+
+	/* One line per size which scripts can pick up */
+	for (i = 0; i < count; i++) {
+		struct membench_result *r = &res[i];
+
+		printf("membench: size=%lu copy=%lu fill=%lu read=%lu latency_ps=%lu\n",
+		       r->size, r->copy, r->fill, r->read, r->latency_ps);
+	}
+	free(res);
+
+	return 0;
+}
+
+/**
+ * membench_check_range() - check that the benchmark may use some memory
+ *
+ * U-Boot uses everything from just below the stack up to gd->ram_top: its
+ * code, malloc area, global data and device tree, and anything reserved
+ * before relocation. The buffer must be in RAM and clear of all of that.
+ *
+ * @addr:	Start of the buffer
+ * @len:	Size of the buffer in bytes
+ * @return 0 if OK, -ve on error
+ */
+static int membench_check_range(ulong addr, ulong len)
+{
+	ulong low, end = addr + len;
+	int __maybe_unused i;
+
+	if (end <= addr)
+		return -EINVAL;
+	low = map_to_sysmem(&low) - MEMBENCH_STACK_MARGIN;
+	if (addr < gd->ram_top && end > low) {
+		printf("Buffer overlaps U-Boot at %08lx ... %08lx\n", low,
+		       (ulong)gd->ram_top - 1);
+		return -EBUSY;
+	}
+#ifdef CONFIG_NR_DRAM_BANKS
+	for (i = 0; i < CONFIG_NR_DRAM_BANKS; i++) {
+		ulong start = gd->bd->bi_dram[i].start;
+
+		if (addr >= start && end <= start + gd->bd->bi_dram[i].size)
+			return 0;
+	}
+#else
+	if (addr >= gd->ram_base && end <= gd->ram_base + gd->ram_size)
+		return 0;
+#endif
+	printf("Buffer is not in RAM\n");
+
+	return -ENOMEM;
+}
+
+static int do_membench(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	ulong size = MEMBENCH_DEFAULT_SIZE;
+	ulong addr;
+	void *buf;
+	int ret;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	addr = simple_strtoul(argv[1], NULL, 16);
+	if (argc > 2)
+		size = simple_strtoul(argv[2], NULL, 16);
+	if (size < MEMBENCH_MIN_SIZE || size > ULONG_MAX / 2)
+		return CMD_RET_USAGE;
+	if (membench_check_range(addr, 2 * size))
+		return CMD_RET_FAILURE;
+
+	printf("Using %08lx ... %08lx (%s)\n", addr, addr + 2 * size - 1,
+	       dcache_status() ? "data cache on" : "data cache off");
+	buf = map_sysmem(addr, 2 * size);
+	ret = membench_run(buf, size);
+	unmap_sysmem(buf);
+	if (ret) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	membench,	3,	0,	do_membench,
+	"memory bandwidth and latency benchmark",
+	"addr [size]\n"
+	"    - measure copy, fill and read bandwidth and load latency for\n"
+	"      buffer sizes from 4 KiB up to 'size' (default 16 MiB), using\n"
+	"      2 * size bytes of memory at 'addr', which is overwritten and\n"
+	"      must be clear of U-Boot"
+);
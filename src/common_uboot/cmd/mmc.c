@@ -323,6 +323,23 @@ static lbaint_t mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+static lbaint_t mmc_sparse_discard(struct sparse_storage *info,
+				   lbaint_t blk, lbaint_t blkcnt)
+{
+	struct blk_desc *dev_desc = info->priv;
+	struct mmc *mmc = find_mmc_device(dev_desc->devnum);
+	lbaint_t grp_size = mmc->erase_grp_size;
+	lbaint_t start, end;
+
+	/* Only erase whole erase groups, to leave other blocks alone */
+	start = (blk + grp_size - 1) & ~(grp_size - 1);
+	end = (blk + blkcnt) & ~(grp_size - 1);
+	if (end <= start)
+		return 0;
+
+	return blk_derase(dev_desc, start, end - start);
+}
+
 static int do_mmc_sparse_write(cmd_tbl_t *cmdtp, int flag,
 			       int argc, char * const argv[])
 {
@@ -363,6 +380,7 @@ static int do_mmc_sparse_write(cmd_tbl_t *cmdtp, int flag,
 	sparse.size = dev_desc->lba - blk;
 	sparse.write = mmc_sparse_write;
 	sparse.reserve = mmc_sparse_reserve;
+	sparse.discard = mmc_sparse_discard;
 	sparse.mssg = NULL;
 	sprintf(dest, "0x" LBAF, sparse.start * sparse.blksz);
 
@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <errno.h>
 #include <mapmem.h>
 #include <trace.h>
 #include <asm/io.h>
@@ -40,6 +41,10 @@ static int create_func_list(int argc, char * const argv[])
 
 	avail = buff_size - buff_ptr;
 	err = trace_list_functions(buff + buff_ptr, avail, &needed);
+	if (err == -ENOENT) {
+		printf("Trace is disabled\n");
+		return 1;
+	}
 	if (err)
 		printf("Error: truncated (%#x bytes needed)\n", needed);
 	used = min(avail, (size_t)needed);
@@ -64,6 +69,10 @@ static int create_call_list(int argc, char * const argv[])
 
 	avail = buff_size - buff_ptr;
 	err = trace_list_calls(buff + buff_ptr, avail, &needed);
+	if (err == -ENOENT) {
+		printf("Trace is disabled\n");
+		return 1;
+	}
 	if (err)
 		printf("Error: truncated (%#x bytes needed)\n", needed);
 	used = min(avail, (size_t)needed);
@@ -77,9 +86,50 @@ static int create_call_list(int argc, char * const argv[])
 	return 0;
 }
 
+/* Include or exclude the functions at the given addresses, or all of them */
+static int set_filter(int argc, char * const argv[], bool traced)
+{
+	int ret = 0;
+	int i;
+
+	if (argc < 3)
+		return -1;
+	for (i = 2; i < argc && !ret; i++) {
+		if (!strcmp(argv[i], "all"))
+			ret = trace_set_filter_all(traced);
+		else
+			ret = trace_set_filter(simple_strtoul(argv[i], NULL, 16),
+					       traced);
+		if (ret == -EINVAL)
+			printf("Address %s is not within U-Boot\n", argv[i]);
+	}
+	if (ret == -ENOENT)
+		printf("Trace is disabled\n");
+
+	return ret ? CMD_RET_FAILURE : 0;
+}
+
+static int set_limit(int argc, char * const argv[], bool sample)
+{
+	ulong val;
+	int ret;
+
+	if (argc < 3)
+		return -1;
+	val = simple_strtoul(argv[2], NULL, 10);
+	ret = sample ? trace_set_sample_us(val) : trace_set_depth_limit(val);
+	if (ret) {
+		printf("Trace is disabled\n");
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
+	int ret;
 
 	if (!cmd)
 		return cmd_usage(cmdtp);
@@ -88,19 +138,42 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		trace_set_enabled(0);
 		break;
 	case 'c':
-		if (create_call_list(argc, argv))
+		ret = create_call_list(argc, argv);
+		if (ret < 0)
 			return cmd_usage(cmdtp);
+		if (ret)
+			return CMD_RET_FAILURE;
 		break;
 	case 'r':
 		trace_set_enabled(1);
 		break;
 	case 'f':
-		if (create_func_list(argc, argv))
+		ret = create_func_list(argc, argv);
+		if (ret < 0)
 			return cmd_usage(cmdtp);
+		if (ret)
+			return CMD_RET_FAILURE;
 		break;
 	case 's':
+		if (!strncmp(cmd, "sa", 2)) {
+			ret = set_limit(argc, argv, true);
+			if (ret < 0)
+				return CMD_RET_USAGE;
+			return ret;
+		}
 		trace_print_stats();
 		break;
+	case 'd':
+		ret = set_limit(argc, argv, false);
+		if (ret < 0)
+			return CMD_RET_USAGE;
+		return ret;
+	case 'i':
+	case 'e':
+		ret = set_filter(argc, argv, *cmd == 'i');
+		if (ret < 0)
+			return CMD_RET_USAGE;
+		return ret;
 	default:
 		return CMD_RET_USAGE;
 	}
@@ -109,12 +182,17 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 }
 
 U_BOOT_CMD(
-	trace,	4,	1,	do_trace,
+	trace,	CONFIG_SYS_MAXARGS,	1,	do_trace,
 	"trace utility commands",
 	"stats                        - display tracing statistics\n"
 	"trace pause                        - pause tracing\n"
 	"trace resume                       - resume tracing\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
-		"- dump function call trace into buffer"
+		"- dump function call trace into buffer\n"
+	"trace depth <limit>                - set call depth limit\n"
+	"trace sample <us>                  "
+		"- record call stack every <us> (0: every call)\n"
+	"trace exclude <func>... | all      - stop recording calls to functions\n"
+	"trace include <func>... | all      - record calls to functions again"
 );
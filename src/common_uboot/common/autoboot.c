@@ -10,6 +10,7 @@
 #include <cli.h>
 #include <console.h>
 #include <fdtdec.h>
+#include <initcall.h>
 #include <menu.h>
 #include <post.h>
 #include <u-boot/sha256.h>
@@ -208,16 +209,21 @@ static int __abortboot(int bootdelay)
 static int menukey;
 #endif
 
-static int __abortboot(int bootdelay)
+static void abortboot_prompt(int bootdelay)
 {
-	int abort = 0;
-	unsigned long ts;
-
 #ifdef CONFIG_MENUPROMPT
 	printf(CONFIG_MENUPROMPT);
 #else
 	printf("Hit any key to stop autoboot: %2d ", bootdelay);
 #endif
+}
+
+static int __abortboot(int bootdelay)
+{
+	int abort = 0;
+	unsigned long ts;
+
+	abortboot_prompt(bootdelay);
 
 	/*
 	 * Check if key already pressed
@@ -243,7 +249,14 @@ static int __abortboot(int bootdelay)
 # endif
 				break;
 			}
-			udelay(10000);
+			/* Use the delay to finish deferred init steps */
+			if (initcall_async_pending()) {
+				putc('\n');
+				initcall_async_poll();
+				abortboot_prompt(bootdelay + 1);
+			} else {
+				udelay(10000);
+			}
 		} while (!abort && get_timer(ts) < 1000);
 
 		printf("\b\b\b%2d ", bootdelay);
@@ -10,6 +10,7 @@
  */
 
 #include <common.h>
+#include <bootm.h>
 #include <console.h>
 #include <environment.h>
 #include <dm.h>
@@ -383,18 +384,110 @@ static int reserve_video(void)
 static int reserve_trace(void)
 {
 #ifdef CONFIG_TRACE
+#if CONFIG_TRACE_BUFFER_ADDR
+	/* The buffer is at a fixed address, outside U-Boot's memory */
+	gd->trace_buff = map_sysmem(CONFIG_TRACE_BUFFER_ADDR,
+				    CONFIG_TRACE_BUFFER_SIZE);
+	debug("Using %dk for trace data at: %08x\n",
+	      CONFIG_TRACE_BUFFER_SIZE >> 10, CONFIG_TRACE_BUFFER_ADDR);
+#else
 	gd->relocaddr -= CONFIG_TRACE_BUFFER_SIZE;
 	gd->trace_buff = map_sysmem(gd->relocaddr, CONFIG_TRACE_BUFFER_SIZE);
 	debug("Reserving %dk for trace data at: %08lx\n",
 	      CONFIG_TRACE_BUFFER_SIZE >> 10, gd->relocaddr);
+#endif
 #endif
 
 	return 0;
 }
 
+#ifdef CONFIG_SKIP_RELOCATE
+/* Environment variables holding addresses that images are loaded to */
+static const char * const in_place_load_vars[] = {
+	"loadaddr",
+	"kernel_addr_r",
+	"fdt_addr_r",
+	"ramdisk_addr_r",
+	"scriptaddr",
+	"pxefile_addr_r",
+};
+
+/**
+ * in_place_overlaps_load() - check U-Boot against an image load address
+ *
+ * An image loaded to @addr may be up to CONFIG_SYS_BOOTM_LEN bytes long,
+ * which is what bootm allows for a decompressed kernel.
+ *
+ * @low:	Lowest address used by U-Boot
+ * @high:	End of U-Boot's image
+ * @addr:	Load address, 0 if none
+ * @return true if an image at @addr could overwrite U-Boot
+ */
+static bool in_place_overlaps_load(ulong low, ulong high, ulong addr)
+{
+	return addr && addr < high && addr + CONFIG_SYS_BOOTM_LEN > low;
+}
+
+/*
+ * U-Boot is linked at its final runtime address, so keep running from
+ * there: relocate_code() then sees a zero offset and skips both the copy
+ * and the .rel.dyn fixups. Everything reserved from here on goes below
+ * the image, so this is only done if none of the board's load addresses
+ * is close enough below (or inside) that range for an image loaded there
+ * to overwrite it.
+ */
+static bool reserve_uboot_in_place(void)
+{
+	ulong start = (ulong)__image_copy_start;
+	ulong low;
+	int i;
+
+	if (start + gd->mon_len > gd->relocaddr) {
+		debug("U-Boot at %08lx overlaps reserved memory, relocating\n",
+		      start);
+		return false;
+	}
+
+	/* Malloc area, bd, gd and device tree, then the stack */
+	low = start - TOTAL_MALLOC_LEN - sizeof(bd_t) - sizeof(gd_t) -
+		CONFIG_SKIP_RELOCATE_STACK_SIZE;
+	if (gd->fdt_blob)
+		low -= ALIGN(fdt_totalsize(gd->fdt_blob) + 0x1000, 32);
+	if (low < gd->ram_base || low > start) {
+		debug("No room below U-Boot at %08lx, relocating\n", start);
+		return false;
+	}
+	if (in_place_overlaps_load(low, start + gd->mon_len,
+				   CONFIG_SYS_LOAD_ADDR)) {
+		debug("U-Boot at %08lx overlaps load address %08lx, relocating\n",
+		      start, (ulong)CONFIG_SYS_LOAD_ADDR);
+		return false;
+	}
+	for (i = 0; i < ARRAY_SIZE(in_place_load_vars); i++) {
+		ulong addr = env_get_ulong(in_place_load_vars[i], 16, 0);
+
+		if (in_place_overlaps_load(low, start + gd->mon_len, addr)) {
+			debug("U-Boot at %08lx overlaps %s=%08lx, relocating\n",
+			      start, in_place_load_vars[i], addr);
+			return false;
+		}
+	}
+
+	gd->relocaddr = start;
+	debug("Keeping U-Boot at its link address %08lx\n", gd->relocaddr);
+
+	return true;
+}
+#else
+static inline bool reserve_uboot_in_place(void)
+{
+	return false;
+}
+#endif
+
 static int reserve_uboot(void)
 {
-	if (!(gd->flags & GD_FLG_SKIP_RELOC)) {
+	if (!(gd->flags & GD_FLG_SKIP_RELOC) && !reserve_uboot_in_place()) {
 		/*
 		 * reserve memory for U-Boot code, data & bss
 		 * round down to next 4 kB limit
@@ -615,6 +708,8 @@ static int reloc_bootstage(void)
 
 static int setup_reloc(void)
 {
+	bootstage_mark_name(BOOTSTAGE_ID_RELOCATE, "relocate");
+
 	if (gd->flags & GD_FLG_SKIP_RELOC) {
 		debug("Skipping relocation due to flag\n");
 		return 0;
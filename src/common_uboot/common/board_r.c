@@ -448,6 +448,44 @@ static int should_load_env(void)
 #endif
 }
 
+#ifdef CONFIG_INITCALL_ASYNC
+/*
+ * Slow probes which the rest of the init sequence does not rely upon are
+ * deferred. They run while waiting for the autoboot key, or at the latest
+ * when the subsystem first looks up a device (see find_mmc_device() and
+ * addr2info()). The device holding the environment is needed by initr_env()
+ * straight away, so it is not deferred.
+ */
+#define DEFINE_INITR_DEFERRED(_func)					\
+	static struct initcall_async _func##_async = {			\
+		.name = #_func,						\
+		.func = _func,						\
+	};								\
+	static int _func##_start(void)					\
+	{								\
+		return initcall_async_start(&_func##_async);		\
+	}
+
+#define INITR_DEFERRED(_func)	_func##_start
+
+#if defined(CONFIG_MTD_NOR_FLASH) && !defined(CONFIG_ENV_IS_IN_FLASH)
+DEFINE_INITR_DEFERRED(initr_flash)
+#define INITR_FLASH		INITR_DEFERRED(initr_flash)
+#endif
+#if defined(CONFIG_MMC) && !defined(CONFIG_ENV_IS_IN_MMC) && \
+	!defined(CONFIG_ENV_IS_IN_FAT) && !defined(CONFIG_ENV_IS_IN_EXT4)
+DEFINE_INITR_DEFERRED(initr_mmc)
+#define INITR_MMC		INITR_DEFERRED(initr_mmc)
+#endif
+#endif
+
+#ifndef INITR_FLASH
+#define INITR_FLASH		initr_flash
+#endif
+#ifndef INITR_MMC
+#define INITR_MMC		initr_mmc
+#endif
+
 static int initr_env(void)
 {
 	/* initialize environment */
@@ -739,7 +777,7 @@ static init_fnc_t init_sequence_r[] = {
 #endif
 	power_init_board,
 #ifdef CONFIG_MTD_NOR_FLASH
-	initr_flash,
+	INITR_FLASH,
 #endif
 	INIT_FUNC_WATCHDOG_RESET
 #if defined(CONFIG_PPC) || defined(CONFIG_M68K) || defined(CONFIG_X86)
@@ -756,7 +794,7 @@ static init_fnc_t init_sequence_r[] = {
 	initr_onenand,
 #endif
 #ifdef CONFIG_MMC
-	initr_mmc,
+	INITR_MMC,
 #endif
 	initr_env,
 #ifdef CONFIG_SYS_BOOTPARAMS_LEN
@@ -412,6 +412,7 @@ static int builtin_not_written(struct child_prog *child);
 /*   o_string manipulation: */
 static int b_check_space(o_string *o, int len);
 static int b_addchr(o_string *o, int ch);
+static void b_addstr(o_string *o, const char *str, int len);
 static void b_reset(o_string *o);
 static int b_addqchr(o_string *o, int ch, int quote);
 #ifndef __U_BOOT__
@@ -890,6 +891,20 @@ static int b_addchr(o_string *o, int ch)
 	return 0;
 }
 
+/* Appending a whole string at once saves a realloc() per character */
+static void b_addstr(o_string *o, const char *str, int len)
+{
+	if (!len)
+		return;
+	if (b_check_space(o, len)) {
+		printf("ERROR : memory not allocated\n");
+		for (;;);
+	}
+	memcpy(o->data + o->length, str, len);
+	o->length += len;
+	o->data[o->length] = '\0';
+}
+
 static void b_reset(o_string *o)
 {
 	o->length = 0;
@@ -1533,7 +1548,7 @@ shell_terminal_error:
  */
 static int run_pipe_real(struct pipe *pi)
 {
-	int i;
+	int i, sp;
 #ifndef __U_BOOT__
 	int nextin, nextout;
 	int pipefds[2];				/* pipefds[0] is for reading */
@@ -1618,6 +1633,7 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1626,11 +1642,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1764,6 +1780,9 @@ static int run_list_real(struct pipe *pi)
 	char **list = NULL;
 	char **save_list = NULL;
 	struct pipe *rpipe;
+#ifdef __U_BOOT__
+	struct pipe *for_pipe = NULL;
+#endif
 	int flag_rep = 0;
 #ifndef __U_BOOT__
 	int save_num_progs;
@@ -1802,7 +1821,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
-					return 1;
+					rcode = 1;
+					goto out;
 				}
 #endif
 				flag_restore = 0;
@@ -1833,6 +1853,9 @@ static int run_list_real(struct pipe *pi)
 				save_list = list;
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
+#ifdef __U_BOOT__
+				for_pipe = pi;
+#endif
 				flag_rep = 1;
 			}
 			if (!(*list)) {
@@ -1902,7 +1925,8 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
-			return -2;	/* exit */
+			rcode = -2;	/* exit */
+			goto out;
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
 #endif
@@ -1922,6 +1946,21 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+#ifdef __U_BOOT__
+out:
+	/*
+	 * If a "for" loop was left part-way through, put back the loop
+	 * variable so that the pipe list is as it was parsed: it may be run
+	 * again from the parse cache, and is freed according to argc.
+	 */
+	if (list) {
+		for (; *list; list++)
+			free(*list);
+		free(for_pipe->progs->argv[0]);
+		free(save_list);
+		for_pipe->progs->argv[0] = save_name;
+	}
+#endif
 	return rcode;
 }
 
@@ -3196,9 +3235,16 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 		update_ifs_map();
 		if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
 		inp->promptmode=1;
+#ifdef __U_BOOT__
+		if (inp->peek == static_peek)
+			bootstage_start(BOOTSTAGE_ID_ACCUM_HUSH_PARSE,
+					"hush_parse");
+#endif
 		rcode = parse_stream(&temp, &ctx, inp,
 				     flag & FLAG_CONT_ON_NEWLINE ? -1 : '\n');
 #ifdef __U_BOOT__
+		if (inp->peek == static_peek)
+			bootstage_accum(BOOTSTAGE_ID_ACCUM_HUSH_PARSE);
 		if (rcode == 1) flag_repeat = 0;
 #endif
 		if (rcode != 1 && ctx.old_flag != 0) {
@@ -3252,6 +3298,192 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #endif /* __U_BOOT__ */
 }
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/*
+ * Scripts held in the environment, such as bootcmd, distro_bootcmd and the
+ * bootcmd_<target> scripts which it runs, are parsed again each time they
+ * are run. The parse cache keeps the pipe lists of recently run scripts so
+ * that they can be run again without parsing. Entries are looked up by the
+ * text of the script, so a script which has been changed simply misses.
+ * Variables are not expanded by the parser, so they still get their
+ * current values each time the script runs.
+ */
+#define PARSE_CACHE_SLOTS	16
+
+/**
+ * struct parse_cache - a parsed script
+ *
+ * @text:	Text of the script (allocated), NULL if the slot is unused
+ * @hash:	Hash of @text
+ * @flag:	Parser flags used for the script (FLAG_...)
+ * @lists:	Pipe list for each line of the script
+ * @count:	Number of entries in @lists
+ * @users:	Number of times the script is currently being run. A script
+ *		can run itself (with 'run'), but a pipe list cannot be
+ *		run twice at once, so the cache is bypassed in that case
+ * @last_used:	Value of parse_cache_clock when last run, to pick the least
+ *		recently used slot for reuse
+ */
+struct parse_cache {
+	char *text;
+	uint hash;
+	int flag;
+	struct pipe **lists;
+	int count;
+	int users;
+	ulong last_used;
+};
+
+static struct parse_cache parse_cache[PARSE_CACHE_SLOTS];
+static ulong parse_cache_clock;
+
+static uint parse_cache_hash(const char *s)
+{
+	uint hash = 2166136261u;
+
+	while (*s) {
+		hash ^= (uchar)*s++;
+		hash *= 16777619;
+	}
+
+	return hash;
+}
+
+static void parse_cache_free(struct parse_cache *pc)
+{
+	int i;
+
+	for (i = 0; i < pc->count; i++)
+		free_pipe_list(pc->lists[i], 0);
+	free(pc->lists);
+	free(pc->text);
+	pc->lists = NULL;
+	pc->count = 0;
+	pc->text = NULL;
+}
+
+/**
+ * parse_cache_fill() - parse a script into a cache slot
+ *
+ * This parses each line in the same way as parse_stream_outer(), but keeps
+ * the pipe lists instead of running them.
+ *
+ * @pc:		Cache slot, with @flag set up
+ * @s:		Text to parse, ending in a newline
+ * @return 0 if OK, 1 on a syntax error
+ */
+static int parse_cache_fill(struct parse_cache *pc, const char *s)
+{
+	o_string temp = NULL_O_STRING;
+	struct in_str input;
+	struct p_context ctx;
+	int flag = pc->flag;
+	int rcode;
+
+	setup_string_in_str(&input, s);
+	do {
+		ctx.type = flag;
+		initialize_context(&ctx);
+		update_ifs_map();
+		if (!(flag & FLAG_PARSE_SEMICOLON))
+			mapset((uchar *)";$&|", 0);
+		input.promptmode = 1;
+		bootstage_start(BOOTSTAGE_ID_ACCUM_HUSH_PARSE, "hush_parse");
+		rcode = parse_stream(&temp, &ctx, &input,
+				     flag & FLAG_CONT_ON_NEWLINE ? -1 : '\n');
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_HUSH_PARSE);
+		if (rcode == 1 || ctx.old_flag != 0) {
+			/* Leave it to parse_stream_outer() to report this */
+			if (ctx.old_flag != 0)
+				free(ctx.stack);
+			free_pipe_list(ctx.list_head, 0);
+			b_free(&temp);
+			return 1;
+		}
+		done_word(&temp, &ctx);
+		done_pipe(&ctx, PIPE_SEQ);
+		b_free(&temp);
+		pc->lists = xrealloc(pc->lists,
+				     (pc->count + 1) * sizeof(*pc->lists));
+		pc->lists[pc->count++] = ctx.list_head;
+	} while (rcode != -1 && !(flag & FLAG_EXIT_FROM_LOOP) &&
+		 b_peek(&input));
+
+	return 0;
+}
+
+/* Run a cached script, in the same way as parse_stream_outer() */
+static int parse_cache_run(struct parse_cache *pc)
+{
+	int code = 1;
+	int i;
+
+	pc->users++;
+	pc->last_used = ++parse_cache_clock;
+	for (i = 0; i < pc->count; i++) {
+		code = run_list_real(pc->lists[i]);
+		if (code == -2) {	/* exit */
+			code = 0;
+			break;
+		}
+		if (code == -1)
+			flag_repeat = 0;
+	}
+	pc->users--;
+
+	return (code != 0) ? 1 : 0;
+}
+
+/**
+ * parse_cache_lookup() - find a script in the parse cache, adding it if needed
+ *
+ * @s:		Text of the script
+ * @s_nl:	Text of the script, ending in a newline
+ * @flag:	Parser flags (FLAG_...)
+ * @return cache slot, or NULL if the script is not to be run from the cache
+ */
+static struct parse_cache *parse_cache_lookup(const char *s, const char *s_nl,
+					      int flag)
+{
+	struct parse_cache *pc, *slot = NULL;
+	uint hash;
+
+	/* Expanded variables are parsed again each time; don't keep them */
+	if (flag & FLAG_REPARSING)
+		return NULL;
+	/* Changing IFS changes the way that scripts are parsed */
+	if (env_get("IFS"))
+		return NULL;
+
+	hash = parse_cache_hash(s);
+	for (pc = parse_cache; pc < parse_cache + PARSE_CACHE_SLOTS; pc++) {
+		if (pc->text && pc->hash == hash && pc->flag == flag &&
+		    !strcmp(pc->text, s))
+			return pc->users ? NULL : pc;
+		if (pc->users)
+			continue;
+		if (!slot || !pc->text ||
+		    (slot->text && pc->last_used < slot->last_used))
+			slot = pc;
+	}
+	if (!slot)
+		return NULL;
+
+	parse_cache_free(slot);
+	slot->text = strdup(s);
+	if (!slot->text)
+		return NULL;
+	slot->hash = hash;
+	slot->flag = flag;
+	if (parse_cache_fill(slot, s_nl)) {
+		parse_cache_free(slot);
+		return NULL;
+	}
+
+	return slot;
+}
+#endif /* CONFIG_HUSH_PARSE_CACHE */
+
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag)
 #else
@@ -3266,6 +3498,23 @@ int parse_string_outer(const char *s, int flag)
 		return 1;
 	if (!*s)
 		return 0;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	{
+		struct parse_cache *pc;
+
+		if (!(p = strchr(s, '\n')) || *++p) {
+			p = xmalloc(strlen(s) + 2);
+			strcpy(p, s);
+			strcat(p, "\n");
+			pc = parse_cache_lookup(s, p, flag);
+			free(p);
+		} else {
+			pc = parse_cache_lookup(s, s, flag);
+		}
+		if (pc)
+			return parse_cache_run(pc);
+	}
+#endif
 	if (!(p = strchr(s, '\n')) || *++p) {
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
@@ -3522,66 +3771,40 @@ static char *insert_var_value(char *inp)
 
 static char *insert_var_value_sub(char *inp, int tag_subst)
 {
-	int res_str_len = 0;
-	int len;
+	o_string res = NULL_O_STRING;
 	int done = 0;
-	char *p, *p1, *res_str = NULL;
+	char *p, *p1;
 
 	while ((p = strchr(inp, SPECIAL_VAR_SYMBOL))) {
-		/* check the beginning of the string for normal characters */
-		if (p != inp) {
-			/* copy any characters to the result string */
-			len = p - inp;
-			res_str = xrealloc(res_str, (res_str_len + len));
-			strncpy((res_str + res_str_len), inp, len);
-			res_str_len += len;
-		}
+		/* copy any normal characters before the variable */
+		b_addstr(&res, inp, p - inp);
 		inp = ++p;
 		/* find the ending marker */
 		p = strchr(inp, SPECIAL_VAR_SYMBOL);
 		*p = '\0';
 		/* look up the value to substitute */
 		if ((p1 = lookup_param(inp))) {
+			/* mark the replaced text to be accepted as is */
 			if (tag_subst)
-				len = res_str_len + strlen(p1) + 2;
-			else
-				len = res_str_len + strlen(p1);
-			res_str = xrealloc(res_str, (1 + len));
-			if (tag_subst) {
-				/*
-				 * copy the variable value to the result
-				 * string
-				 */
-				strcpy((res_str + res_str_len + 1), p1);
-
-				/*
-				 * mark the replaced text to be accepted as
-				 * is
-				 */
-				res_str[res_str_len] = SUBSTED_VAR_SYMBOL;
-				res_str[res_str_len + 1 + strlen(p1)] =
-					SUBSTED_VAR_SYMBOL;
-			} else
-				/*
-				 * copy the variable value to the result
-				 * string
-				 */
-				strcpy((res_str + res_str_len), p1);
-
-			res_str_len = len;
+				b_addchr(&res, SUBSTED_VAR_SYMBOL);
+			b_addstr(&res, p1, strlen(p1));
+			if (tag_subst)
+				b_addchr(&res, SUBSTED_VAR_SYMBOL);
 		}
 		*p = SPECIAL_VAR_SYMBOL;
 		inp = ++p;
 		done = 1;
 	}
-	if (done) {
-		res_str = xrealloc(res_str, (1 + res_str_len + strlen(inp)));
-		strcpy((res_str + res_str_len), inp);
-		while ((p = strchr(res_str, '\n'))) {
-			*p = ' ';
-		}
-	}
-	return (res_str == NULL) ? inp : res_str;
+	if (!done)
+		return inp;
+
+	/* make sure there is a string to return, even if it is empty */
+	b_check_space(&res, 1);
+	b_addstr(&res, inp, strlen(inp));
+	for (p = res.data; (p = strchr(p, '\n')); p++)
+		*p = ' ';
+
+	return res.data;
 }
 
 static char **make_list_in(char **inp, char *name)
@@ -3631,10 +3854,9 @@ static char **make_list_in(char **inp, char *name)
  */
 static char *make_string(char **inp, int *nonnull)
 {
+	o_string str = NULL_O_STRING;
 	char *p;
-	char *str = NULL;
 	int n;
-	int len = 2;
 	char *noeval_str;
 	int noeval = 0;
 
@@ -3643,24 +3865,18 @@ static char *make_string(char **inp, int *nonnull)
 		noeval = 1;
 	for (n = 0; inp[n]; n++) {
 		p = insert_var_value_sub(inp[n], noeval);
-		str = xrealloc(str, (len + strlen(p) + (2 * nonnull[n])));
-		if (n) {
-			strcat(str, " ");
-		} else {
-			*str = '\0';
-		}
+		if (n)
+			b_addchr(&str, ' ');
 		if (nonnull[n])
-			strcat(str, "'");
-		strcat(str, p);
+			b_addchr(&str, '\'');
+		b_addstr(&str, p, strlen(p));
 		if (nonnull[n])
-			strcat(str, "'");
-		len = strlen(str) + 3;
+			b_addchr(&str, '\'');
 		if (p != inp[n]) free(p);
 	}
-	len = strlen(str);
-	*(str + len) = '\n';
-	*(str + len + 1) = '\0';
-	return str;
+	b_addchr(&str, '\n');
+
+	return str.data;
 }
 
 #ifdef __U_BOOT__
@@ -8,6 +8,7 @@
 
 #include <common.h>
 #include <flash.h>
+#include <initcall.h>
 
 #include <mtd/cfi_flash.h>
 
@@ -17,6 +18,17 @@ extern flash_info_t  flash_info[]; /* info for FLASH chips */
  * Functions
  */
 
+/*-----------------------------------------------------------------------
+ * Finish probing the flash if board_init_r() deferred it (INITCALL_ASYNC).
+ * Call this before using flash_info[].
+ */
+void flash_wait_deferred_init(void)
+{
+#ifndef CONFIG_SPL_BUILD
+	initcall_async_wait_name("initr_flash");
+#endif
+}
+
 /*-----------------------------------------------------------------------
  * Set protection status for monitor sectors
  *
@@ -89,6 +101,7 @@ addr2info (ulong addr)
 	flash_info_t *info;
 	int i;
 
+	flash_wait_deferred_init();
 	for (i=0, info = &flash_info[0]; i<CONFIG_SYS_MAX_FLASH_BANKS; ++i, ++info) {
 		if (info->flash_id != FLASH_UNKNOWN &&
 		    addr >= info->start[0] &&
@@ -6,8 +6,13 @@
 #define IOTRACE_IMPL
 
 #include <common.h>
+#include <errno.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#ifdef CONFIG_IO_TRACE_CYCLE_COUNTER
+#include <asm/armv7_pmu.h>
+#endif
+#include <linux/bitops.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -22,6 +27,13 @@ DECLARE_GLOBAL_DATA_PTR;
  * @region_size: Size of region to trace. if 0 will trace all address space
  * @crc32:	Current value of CRC chceksum of trace records
  * @enabled:	true if enabled, false if disabled
+ * @busy:	true while an access is being traced, so that any I/O done by
+ *		the tracing itself (e.g. reading the timer) is not traced
+ * @tick_overhead: Ticks taken by reading the tick counter, which is taken
+ *		off each latency
+ * @window_count: Number of statistics windows in use
+ * @windows:	Statistics windows
+ * @other:	Statistics for accesses outside all of @windows
  */
 static struct iotrace {
 	ulong start;
@@ -32,9 +44,105 @@ static struct iotrace {
 	ulong region_size;
 	u32 crc32;
 	bool enabled;
-} iotrace;
+	bool busy;
+	ulong tick_overhead;
+	int window_count;
+	struct iotrace_window windows[IOTRACE_MAX_WINDOWS];
+	struct iotrace_window other;
+} iotrace = {
+	.other = { .name = "other" },
+};
+
+#ifdef CONFIG_IO_TRACE_CYCLE_COUNTER
+/* The ARMv7 PMU cycle counter (PMCCNTR) */
+static inline ulong iotrace_get_ticks(void)
+{
+	return armv7_pmu_get_cycles();
+}
+
+static void iotrace_start_ticks(void)
+{
+	armv7_pmu_start_cycles();
+}
+#else
+static inline ulong iotrace_get_ticks(void)
+{
+#ifdef CONFIG_SYS_TIMER_COUNTER
+	return timer_read_counter();
+#else
+	return get_ticks();
+#endif
+}
+
+static void iotrace_start_ticks(void)
+{
+}
+#endif
 
-static void add_record(int flags, const void *ptr, ulong value)
+/* Work out how long it takes to read the tick counter */
+static void iotrace_calibrate(void)
+{
+	ulong ticks, best = ~0UL;
+	int i;
+
+	iotrace_start_ticks();
+	iotrace.busy = true;
+	for (i = 0; i < 8; i++) {
+		ticks = iotrace_get_ticks();
+		ticks = iotrace_get_ticks() - ticks;
+		best = min(best, ticks);
+	}
+	iotrace.busy = false;
+	iotrace.tick_overhead = best;
+}
+
+static struct iotrace_window *find_window(ulong addr)
+{
+	struct iotrace_window *win;
+	int i;
+
+	for (i = 0, win = iotrace.windows; i < iotrace.window_count;
+	     i++, win++) {
+		if (addr - win->start < win->size)
+			return win;
+	}
+
+	return &iotrace.other;
+}
+
+static void update_window(int flags, ulong addr, ulong value, ulong ticks)
+{
+	struct iotrace_window *win = find_window(addr);
+
+	win->ticks += ticks;
+	win->max_ticks = max(win->max_ticks, ticks);
+	win->hist[min(fls(ticks), IOTRACE_HIST_BUCKETS - 1)]++;
+	if (flags & IOT_WRITE) {
+		win->writes++;
+		win->poll_run = 0;
+		return;
+	}
+
+	/*
+	 * Reading the same register again and getting the same value back
+	 * is almost always a loop waiting for a status bit to change
+	 */
+	win->reads++;
+	if (win->poll_run && addr == win->last_addr &&
+	    value == win->last_value) {
+		win->polls++;
+		if (++win->poll_run > win->max_poll_run) {
+			win->max_poll_run = win->poll_run;
+			win->max_poll_addr = addr;
+		}
+	} else {
+		win->poll_run = 1;
+		win->last_addr = addr;
+		win->last_value = value;
+	}
+}
+
+static void add_record(int flags, const void *ptr, ulong value, ulong ticks)
 {
 	struct iotrace_record srec, *rec = &srec;
 
@@ -47,6 +155,7 @@ static void add_record(int flags, const void *ptr, ulong value)
 	if (!(gd->flags & GD_FLG_RELOC) || !iotrace.enabled)
 		return;
 
+	update_window(flags, map_to_sysmem(ptr), value, ticks);
 	if (iotrace.region_size)
 		if ((ulong)ptr < iotrace.region_start ||
 		    (ulong)ptr > iotrace.region_start + iotrace.region_size)
@@ -65,6 +174,7 @@ static void add_record(int flags, const void *ptr, ulong value)
 
 	rec->timestamp = timer_get_us();
 	rec->flags = flags;
+	rec->latency = ticks;
 	rec->addr = map_to_sysmem(ptr);
 	rec->value = value;
 
@@ -76,52 +186,107 @@ static void add_record(int flags, const void *ptr, ulong value)
 	iotrace.offset += sizeof(struct iotrace_record);
 }
 
+/**
+ * iotrace_begin() - start tracing an access
+ *
+ * @startp:	Returns the tick count before the access
+ * @return true if the access should be traced, false if not
+ */
+static bool iotrace_begin(ulong *startp)
+{
+	/* See add_record() for why nothing is traced before relocation */
+	if (!(gd->flags & GD_FLG_RELOC) || !iotrace.enabled || iotrace.busy)
+		return false;
+	iotrace.busy = true;
+	*startp = iotrace_get_ticks();
+
+	return true;
+}
+
+/* Finish tracing an access which was started by iotrace_begin() */
+static void iotrace_end(int flags, const void *ptr, ulong value, ulong start)
+{
+	ulong ticks = iotrace_get_ticks() - start;
+
+	ticks = ticks > iotrace.tick_overhead ? ticks - iotrace.tick_overhead :
+		0;
+	add_record(flags, ptr, value, ticks);
+	iotrace.busy = false;
+}
+
 u32 iotrace_readl(const void *ptr)
 {
+	ulong start;
 	u32 v;
 
+	if (!iotrace_begin(&start))
+		return readl(ptr);
 	v = readl(ptr);
-	add_record(IOT_32 | IOT_READ, ptr, v);
+	iotrace_end(IOT_32 | IOT_READ, ptr, v, start);
 
 	return v;
 }
 
 void iotrace_writel(ulong value, const void *ptr)
 {
-	add_record(IOT_32 | IOT_WRITE, ptr, value);
+	ulong start;
+
+	if (!iotrace_begin(&start)) {
+		writel(value, ptr);
+		return;
+	}
 	writel(value, ptr);
+	iotrace_end(IOT_32 | IOT_WRITE, ptr, value, start);
 }
 
 u16 iotrace_readw(const void *ptr)
 {
+	ulong start;
 	u32 v;
 
+	if (!iotrace_begin(&start))
+		return readw(ptr);
 	v = readw(ptr);
-	add_record(IOT_16 | IOT_READ, ptr, v);
+	iotrace_end(IOT_16 | IOT_READ, ptr, v, start);
 
 	return v;
 }
 
 void iotrace_writew(ulong value, const void *ptr)
 {
-	add_record(IOT_16 | IOT_WRITE, ptr, value);
+	ulong start;
+
+	if (!iotrace_begin(&start)) {
+		writew(value, ptr);
+		return;
+	}
 	writew(value, ptr);
+	iotrace_end(IOT_16 | IOT_WRITE, ptr, value, start);
 }
 
 u8 iotrace_readb(const void *ptr)
 {
+	ulong start;
 	u32 v;
 
+	if (!iotrace_begin(&start))
+		return readb(ptr);
 	v = readb(ptr);
-	add_record(IOT_8 | IOT_READ, ptr, v);
+	iotrace_end(IOT_8 | IOT_READ, ptr, v, start);
 
 	return v;
 }
 
 void iotrace_writeb(ulong value, const void *ptr)
 {
-	add_record(IOT_8 | IOT_WRITE, ptr, value);
+	ulong start;
+
+	if (!iotrace_begin(&start)) {
+		writeb(value, ptr);
+		return;
+	}
 	writeb(value, ptr);
+	iotrace_end(IOT_8 | IOT_WRITE, ptr, value, start);
 }
 
 void iotrace_reset_checksum(void)
@@ -154,6 +319,8 @@ void iotrace_get_region(ulong *start, ulong *size)
 
 void iotrace_set_enabled(int enable)
 {
+	if (enable && !iotrace.enabled)
+		iotrace_calibrate();
 	iotrace.enabled = enable;
 }
 
@@ -178,3 +345,57 @@ void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *of
 	*offset = iotrace.offset;
 	*count = iotrace.offset / sizeof(struct iotrace_record);
 }
+
+int iotrace_add_window(const char *name, ulong start, ulong size)
+{
+	struct iotrace_window *win;
+
+	if (!size)
+		return -EINVAL;
+	if (iotrace.window_count == IOTRACE_MAX_WINDOWS)
+		return -ENOSPC;
+	win = &iotrace.windows[iotrace.window_count];
+	memset(win, '\0', sizeof(*win));
+	strlcpy(win->name, name, sizeof(win->name));
+	win->start = start;
+	win->size = size;
+
+	return iotrace.window_count++;
+}
+
+void iotrace_clear_windows(void)
+{
+	iotrace.window_count = 0;
+}
+
+static void reset_window(struct iotrace_window *win)
+{
+	win->reads = 0;
+	win->writes = 0;
+	win->ticks = 0;
+	win->max_ticks = 0;
+	win->polls = 0;
+	win->max_poll_run = 0;
+	win->max_poll_addr = 0;
+	win->poll_run = 0;
+	memset(win->hist, '\0', sizeof(win->hist));
+}
+
+void iotrace_reset_stats(void)
+{
+	int i;
+
+	for (i = 0; i < iotrace.window_count; i++)
+		reset_window(&iotrace.windows[i]);
+	reset_window(&iotrace.other);
+}
+
+const struct iotrace_window *iotrace_get_window(int index)
+{
+	if (index < 0 || index > iotrace.window_count)
+		return NULL;
+	if (index == iotrace.window_count)
+		return &iotrace.other;
+
+	return &iotrace.windows[index];
+}
@@ -45,13 +45,23 @@ int spl_load_image_ext(struct spl_image_info *spl_image,
 		goto end;
 	}
 
+	if (IS_ENABLED(CONFIG_SPL_COPY_PAYLOAD_ONLY))
+		spl_image->flags |= SPL_COPY_PAYLOAD_ONLY;
+
 	err = spl_parse_image_header(spl_image, header);
 	if (err < 0) {
 		puts("spl: ext: failed to parse image header\n");
 		goto end;
 	}
 
-	err = ext4fs_read((char *)spl_image->load_addr, 0, filelen, &actlen);
+	if (image_get_magic(header) == IH_MAGIC &&
+	    (spl_image->flags & SPL_COPY_PAYLOAD_ONLY))
+		err = ext4fs_read((char *)spl_image->load_addr,
+				  sizeof(struct image_header), spl_image->size,
+				  &actlen);
+	else
+		err = ext4fs_read((char *)spl_image->load_addr, 0, filelen,
+				  &actlen);
 
 end:
 #ifdef CONFIG_SPL_LIBCOMMON_SUPPORT
@@ -120,6 +130,7 @@ int spl_load_image_ext_os(struct spl_image_info *spl_image,
 defaults:
 #endif
 
+#ifdef CONFIG_SPL_FS_LOAD_ARGS_NAME
 	err = ext4fs_open(CONFIG_SPL_FS_LOAD_ARGS_NAME, &filelen);
 	if (err < 0)
 		puts("spl: ext4fs_open failed\n");
@@ -132,6 +143,7 @@ defaults:
 #endif
 		return -1;
 	}
+#endif
 
 	return spl_load_image_ext(spl_image, block_dev, partition,
 			CONFIG_SPL_FS_LOAD_KERNEL_NAME);
@@ -12,6 +12,8 @@
 #include <part.h>
 #include <ubifs_uboot.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 #undef	PART_DEBUG
 
 #ifdef	PART_DEBUG
@@ -30,6 +32,20 @@ static struct part_driver *part_driver_lookup_type(struct blk_desc *dev_desc)
 	const int n_ents = ll_entry_count(struct part_driver, part_driver);
 	struct part_driver *entry;
 
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+	/*
+	 * Look for the partition table again once the device has changed.
+	 * Until then, also remember that none was found (part_type_gen is 0
+	 * if the tests have not been run since the device was set up, or
+	 * if the device could not be read last time).
+	 */
+	if (dev_desc->part_type_gen != dev_desc->change_gen)
+		dev_desc->part_type = PART_TYPE_UNKNOWN;
+	else if (dev_desc->part_type == PART_TYPE_UNKNOWN &&
+		 dev_desc->part_type_gen)
+		return NULL;
+	dev_desc->part_type_gen = dev_desc->change_gen;
+#endif
 	if (dev_desc->part_type == PART_TYPE_UNKNOWN) {
 		for (entry = drv; entry != drv + n_ents; entry++) {
 			int ret;
@@ -39,6 +55,10 @@ static struct part_driver *part_driver_lookup_type(struct blk_desc *dev_desc)
 				dev_desc->part_type = entry->part_type;
 				return entry;
 			}
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+			if (ret == -EIO)
+				dev_desc->part_type_gen = 0;
+#endif
 		}
 	} else {
 		for (entry = drv; entry != drv + n_ents; entry++) {
@@ -231,8 +251,10 @@ void part_init(struct blk_desc *dev_desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(dev_desc->if_type, dev_desc->devnum);
+	blk_mark_changed(dev_desc);
 
 	dev_desc->part_type = PART_TYPE_UNKNOWN;
+	dev_desc->part_type_gen = dev_desc->change_gen;
 	for (entry = drv; entry != drv + n_ents; entry++) {
 		int ret;
 
@@ -307,13 +329,105 @@ void part_print(struct blk_desc *dev_desc)
 		drv->print(dev_desc);
 }
 
+/**
+ * struct part_cache_entry - result of looking up one partition
+ *
+ * @known:	true if @ret and @info are filled in
+ * @ret:	Value returned by part_get_info()
+ * @info:	Partition information, if @ret is 0
+ */
+struct part_cache_entry {
+	bool known;
+	int ret;
+	disk_partition_t info;
+};
+
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+/*
+ * Scripts look up a partition for every file they load, and distro boot
+ * lists all the partitions on each device, and each lookup reads and
+ * checks the partition table again. So remember what part_get_info()
+ * returned for each partition of the last few devices, until the device
+ * is written or its media changes (see blk_mark_changed()).
+ */
+#define PART_CACHE_DEVICES	4
+
+/**
+ * struct part_cache - partitions found on a device
+ *
+ * @desc:	Block device, or NULL if the entry is unused
+ * @hwpart:	Hardware partition selected on @desc
+ * @change_gen:	Value of @desc->change_gen when the entries were filled in
+ * @parts:	Entries for partitions 1 to MAX_SEARCH_PARTITIONS (allocated)
+ */
+struct part_cache {
+	struct blk_desc *desc;
+	int hwpart;
+	unsigned int change_gen;
+	struct part_cache_entry *parts;
+};
+
+static struct part_cache part_cache[PART_CACHE_DEVICES];
+static int part_cache_next;
+
+/**
+ * part_cache_get() - get the cache entry for a partition
+ *
+ * @dev_desc:	Block device
+ * @part:	Partition number
+ * @return entry, which may not be filled in yet, or NULL if the partition
+ * cannot be cached
+ */
+static struct part_cache_entry *part_cache_get(struct blk_desc *dev_desc,
+					       int part)
+{
+	struct part_cache *pc;
+
+	if (part < 1 || part > MAX_SEARCH_PARTITIONS ||
+	    !(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+
+	for (pc = part_cache; pc < part_cache + PART_CACHE_DEVICES; pc++) {
+		if (pc->desc == dev_desc && pc->hwpart == dev_desc->hwpart)
+			break;
+	}
+	if (pc == part_cache + PART_CACHE_DEVICES) {
+		pc = &part_cache[part_cache_next];
+		part_cache_next = (part_cache_next + 1) % PART_CACHE_DEVICES;
+		pc->desc = NULL;
+	}
+	if (!pc->parts) {
+		pc->parts = calloc(MAX_SEARCH_PARTITIONS, sizeof(*pc->parts));
+		if (!pc->parts)
+			return NULL;
+	}
+	if (!pc->desc || pc->change_gen != dev_desc->change_gen) {
+		memset(pc->parts, '\0',
+		       MAX_SEARCH_PARTITIONS * sizeof(*pc->parts));
+		pc->desc = dev_desc;
+		pc->hwpart = dev_desc->hwpart;
+		pc->change_gen = dev_desc->change_gen;
+	}
+
+	return &pc->parts[part - 1];
+}
+#else
+static struct part_cache_entry *part_cache_get(struct blk_desc *dev_desc,
+					       int part)
+{
+	return NULL;
+}
+#endif
+
 #endif /* CONFIG_HAVE_BLOCK_DEVICE */
 
 int part_get_info(struct blk_desc *dev_desc, int part,
 		       disk_partition_t *info)
 {
 #ifdef CONFIG_HAVE_BLOCK_DEVICE
+	struct part_cache_entry *entry;
 	struct part_driver *drv;
+	int ret;
 
 #if CONFIG_IS_ENABLED(PARTITION_UUIDS)
 	/* The common case is no UUID support */
@@ -334,10 +448,27 @@ int part_get_info(struct blk_desc *dev_desc, int part,
 		       drv->name);
 		return -ENOSYS;
 	}
-	if (drv->get_info(dev_desc, part, info) == 0) {
+	entry = part_cache_get(dev_desc, part);
+	if (entry && entry->known) {
+		if (!entry->ret)
+			*info = entry->info;
+		return entry->ret;
+	}
+	ret = drv->get_info(dev_desc, part, info);
+	if (ret == 0) {
 		PRINTF("## Valid %s partition found ##\n", drv->name);
+		if (entry) {
+			entry->known = true;
+			entry->ret = 0;
+			entry->info = *info;
+		}
 		return 0;
 	}
+	/* Read errors may go away, so only remember a missing partition */
+	if (entry && ret == -ENOENT) {
+		entry->known = true;
+		entry->ret = -1;
+	}
 #endif /* CONFIG_HAVE_BLOCK_DEVICE */
 
 	return -1;
@@ -92,7 +92,7 @@ static int part_test_dos(struct blk_desc *dev_desc)
 	ALLOC_CACHE_ALIGN_BUFFER(legacy_mbr, mbr, 1);
 
 	if (blk_dread(dev_desc, 0, 1, (ulong *)mbr) != 1)
-		return -1;
+		return -EIO;
 
 	if (test_block_type((unsigned char *)mbr) != DOS_MBR)
 		return -1;
@@ -106,7 +106,7 @@ static int part_test_dos(struct blk_desc *dev_desc)
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buffer, dev_desc->blksz);
 
 	if (blk_dread(dev_desc, 0, 1, (ulong *)buffer) != 1)
-		return -1;
+		return -EIO;
 
 	if (test_block_type(buffer) != DOS_MBR)
 		return -1;
@@ -271,7 +271,7 @@ static int part_get_info_extended(struct blk_desc *dev_desc,
 		return 0;
 	}
 
-	return -1;
+	return -ENOENT;
 }
 
 void part_print_dos(struct blk_desc *dev_desc)
@@ -302,7 +302,7 @@ int part_get_info_efi(struct blk_desc *dev_desc, int part,
 		debug("%s: *** ERROR: Invalid partition number %d ***\n",
 			__func__, part);
 		free(gpt_pte);
-		return -1;
+		return -ENOENT;
 	}
 
 	/* The 'lbaint_t' casting may limit the maximum disk size to 2 TB */
@@ -338,10 +338,10 @@ static int part_test_efi(struct blk_desc *dev_desc)
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, legacymbr, 1, dev_desc->blksz);
 
 	/* Read legacy MBR from block 0 and validate it */
-	if ((blk_dread(dev_desc, 0, 1, (ulong *)legacymbr) != 1)
-		|| (is_pmbr_valid(legacymbr) != 1)) {
+	if (blk_dread(dev_desc, 0, 1, (ulong *)legacymbr) != 1)
+		return -EIO;
+	if (is_pmbr_valid(legacymbr) != 1)
 		return -1;
-	}
 	return 0;
 }
 
@@ -918,6 +918,87 @@ static int is_pmbr_valid(legacy_mbr * mbr)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(PARTITION_CACHE)
+/*
+ * Each partition lookup checks the whole GPT: the header, and a CRC over
+ * the entries, which are 16 KiB with the usual 128 entries. Keep a copy
+ * of the last GPT found valid until the device changes (see
+ * blk_mark_changed()), and hand out copies of that.
+ */
+static struct {
+	struct blk_desc *desc;
+	int hwpart;
+	unsigned int change_gen;
+	u64 lba;
+	gpt_header head;
+	gpt_entry *pte;
+	size_t pte_size;
+} gpt_cache;
+
+/**
+ * gpt_cache_get() - get a GPT from the cache
+ *
+ * @dev_desc:	Block device
+ * @lba:	Block of the GPT header
+ * @pgpt_head:	Returns the GPT header
+ * @pgpt_pte:	Returns a copy of the entries, to be freed by the caller
+ * @return 1 if found, 0 if not
+ */
+static int gpt_cache_get(struct blk_desc *dev_desc, u64 lba,
+			 gpt_header *pgpt_head, gpt_entry **pgpt_pte)
+{
+	gpt_entry *pte;
+
+	if (!gpt_cache.pte || gpt_cache.desc != dev_desc ||
+	    gpt_cache.hwpart != dev_desc->hwpart ||
+	    gpt_cache.change_gen != dev_desc->change_gen ||
+	    gpt_cache.lba != lba)
+		return 0;
+
+	pte = memalign(ARCH_DMA_MINALIGN,
+		       PAD_TO_BLOCKSIZE(gpt_cache.pte_size, dev_desc));
+	if (!pte)
+		return 0;
+	memcpy(pte, gpt_cache.pte, gpt_cache.pte_size);
+	memcpy(pgpt_head, &gpt_cache.head, sizeof(gpt_cache.head));
+	*pgpt_pte = pte;
+
+	return 1;
+}
+
+static void gpt_cache_put(struct blk_desc *dev_desc, u64 lba,
+			  gpt_header *pgpt_head, gpt_entry *pgpt_pte)
+{
+	size_t size = le32_to_cpu(pgpt_head->num_partition_entries) *
+		le32_to_cpu(pgpt_head->sizeof_partition_entry);
+
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return;
+	free(gpt_cache.pte);
+	gpt_cache.pte = malloc(size);
+	if (!gpt_cache.pte)
+		return;
+	memcpy(gpt_cache.pte, pgpt_pte, size);
+	gpt_cache.pte_size = size;
+	memcpy(&gpt_cache.head, pgpt_head, sizeof(gpt_cache.head));
+	gpt_cache.desc = dev_desc;
+	gpt_cache.hwpart = dev_desc->hwpart;
+	gpt_cache.change_gen = dev_desc->change_gen;
+	gpt_cache.lba = lba;
+}
+#else
+static int gpt_cache_get(struct blk_desc *dev_desc, u64 lba,
+			 gpt_header *pgpt_head, gpt_entry **pgpt_pte)
+{
+	return 0;
+}
+
+static void gpt_cache_put(struct blk_desc *dev_desc, u64 lba,
+			  gpt_header *pgpt_head, gpt_entry *pgpt_pte)
+{
+}
+#endif
+
 /**
  * is_gpt_valid() - tests one GPT header and PTEs for validity
  *
@@ -937,6 +1018,9 @@ static int is_gpt_valid(struct blk_desc *dev_desc, u64 lba,
 		return 0;
 	}
 
+	if (gpt_cache_get(dev_desc, lba, pgpt_head, pgpt_pte))
+		return 1;
+
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, mbr, 1, dev_desc->blksz);
 
 	/* Read MBR Header from device */
@@ -977,6 +1061,7 @@ static int is_gpt_valid(struct blk_desc *dev_desc, u64 lba,
 		free(*pgpt_pte);
 		return 0;
 	}
+	gpt_cache_put(dev_desc, lba, pgpt_head, *pgpt_pte);
 
 	/* We're done, all's well */
 	return 1;
@@ -44,13 +44,15 @@ static int part_test_mac(struct blk_desc *dev_desc)
 	ALLOC_CACHE_ALIGN_BUFFER(mac_driver_desc_t, ddesc, 1);
 	ALLOC_CACHE_ALIGN_BUFFER(mac_partition_t, mpart, 1);
 	ulong i, n;
+	int ret;
 
-	if (part_mac_read_ddb (dev_desc, ddesc)) {
+	ret = part_mac_read_ddb(dev_desc, ddesc);
+	if (ret) {
 		/*
 		 * error reading Driver Descriptor Block,
 		 * or no valid Signature
 		 */
-		return (-1);
+		return ret;
 	}
 
 	n = 1;	/* assuming at least one partition */
@@ -159,7 +161,7 @@ static int part_mac_read_ddb(struct blk_desc *dev_desc,
 {
 	if (blk_dread(dev_desc, 0, 1, (ulong *)ddb_p) != 1) {
 		debug("** Can't read Driver Descriptor Block **\n");
-		return (-1);
+		return -EIO;
 	}
 
 	if (ddb_p->signature != MAC_DRIVER_MAGIC) {
@@ -11,6 +11,8 @@
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
 
+unsigned int blk_change_gen;
+
 static const char *if_typename_str[IF_TYPE_COUNT] = {
 	[IF_TYPE_IDE]		= "ide",
 	[IF_TYPE_SCSI]		= "scsi",
@@ -432,6 +434,7 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blk_mark_changed(block_dev);
 	return ops->write(dev, start, blkcnt, buffer);
 }
 
@@ -445,6 +448,7 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blk_mark_changed(block_dev);
 	return ops->erase(dev, start, blkcnt);
 }
 
@@ -7,6 +7,8 @@
 #include <common.h>
 #include <linux/err.h>
 
+unsigned int blk_change_gen;
+
 struct blk_driver *blk_driver_lookup_type(int if_type)
 {
 	struct blk_driver *drv = ll_entry_start(struct blk_driver, blk_driver);
@@ -246,6 +248,7 @@ ulong blk_write_devnum(enum if_type if_type, int devnum, lbaint_t start,
 	ret = get_desc(drv, devnum, &desc);
 	if (ret)
 		return ret;
+	blk_mark_changed(desc);
 	return desc->block_write(desc, start, blkcnt, buffer);
 }
 
@@ -30,6 +30,22 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#if CONFIG_IS_ENABLED(DM_STATS)
+/*
+ * Timestamp for bind/probe statistics. While the timer device itself is
+ * being set up there is no time source, so return 0 rather than recursing
+ * back into driver model.
+ */
+static ulong dm_stats_get_us(void)
+{
+#ifdef CONFIG_TIMER
+	if (!gd->timer)
+		return 0;
+#endif
+	return timer_get_us();
+}
+#endif
+
 static int device_bind_common(struct udevice *parent, const struct driver *drv,
 			      const char *name, void *platdata,
 			      ulong driver_data, ofnode node,
@@ -38,6 +54,9 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	struct udevice *dev;
 	struct uclass *uc;
 	int size, ret = 0;
+#if CONFIG_IS_ENABLED(DM_STATS)
+	ulong start = dm_stats_get_us();
+#endif
 
 	if (devp)
 		*devp = NULL;
@@ -168,6 +187,9 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		*devp = dev;
 
 	dev->flags |= DM_FLAG_BOUND;
+#if CONFIG_IS_ENABLED(DM_STATS)
+	dev->bind_time = dm_stats_get_us() - start;
+#endif
 
 	return 0;
 
@@ -310,6 +332,9 @@ int device_probe(struct udevice *dev)
 	int size = 0;
 	int ret;
 	int seq;
+#if CONFIG_IS_ENABLED(DM_STATS)
+	ulong start;
+#endif
 
 	if (!dev)
 		return -EINVAL;
@@ -367,6 +392,10 @@ int device_probe(struct udevice *dev)
 			return 0;
 	}
 
+#if CONFIG_IS_ENABLED(DM_STATS)
+	/* Parents have their own probe time, so don't count it here */
+	start = dm_stats_get_us();
+#endif
 	seq = uclass_resolve_seq(dev);
 	if (seq < 0) {
 		ret = seq;
@@ -425,6 +454,9 @@ int device_probe(struct udevice *dev)
 
 	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL)
 		pinctrl_select_state(dev, "default");
+#if CONFIG_IS_ENABLED(DM_STATS)
+	dev->probe_time = dm_stats_get_us() - start;
+#endif
 
 	return 0;
 fail_uclass:
@@ -96,3 +96,41 @@ void dm_dump_uclass(void)
 		puts("\n");
 	}
 }
+
+#if CONFIG_IS_ENABLED(DM_STATS)
+static void show_stats(struct udevice *dev, ulong *bind_total,
+		       ulong *probe_total, int *count)
+{
+	struct udevice *child;
+
+	printf(" %-10.10s  %-10.10s  %-20.20s  %8lu  %9lu\n",
+	       dev->uclass->uc_drv->name, dev->driver->name, dev->name,
+	       dev->bind_time, dev->probe_time);
+	*bind_total += dev->bind_time;
+	*probe_total += dev->probe_time;
+	(*count)++;
+
+	list_for_each_entry(child, &dev->child_head, sibling_node)
+		show_stats(child, bind_total, probe_total, count);
+}
+
+void dm_dump_stats(void)
+{
+	ulong bind_total = 0, probe_total = 0;
+	struct udevice *root;
+	int count = 0;
+
+	root = dm_root();
+	if (!root)
+		return;
+
+	printf(" Class       Driver      Name                  Bind(us)  Probe(us)\n");
+	printf("-------------------------------------------------------------------\n");
+	show_stats(root, &bind_total, &probe_total, &count);
+	printf("-------------------------------------------------------------------\n");
+	printf(" %d devices, bind %lu us, probe %lu us\n", count, bind_total,
+	       probe_total);
+	if (CONFIG_IS_ENABLED(DM_LAZY_BIND))
+		printf(" %d devices not bound yet\n", dm_lazy_count());
+}
+#endif
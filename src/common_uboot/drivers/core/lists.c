@@ -195,4 +195,29 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp)
 
 	return result;
 }
+
+struct driver *lists_find_fdt_driver(ofnode node)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id;
+	const char *compat_list, *compat;
+	struct driver *entry;
+	int compat_length, i;
+
+	compat_list = ofnode_get_property(node, "compatible", &compat_length);
+	if (!compat_list)
+		return NULL;
+
+	for (i = 0; i < compat_length; i += strlen(compat) + 1) {
+		compat = compat_list + i;
+		for (entry = driver; entry != driver + n_ents; entry++) {
+			if (!driver_check_compatible(entry->of_match, &id,
+						     compat))
+				return entry;
+		}
+	}
+
+	return NULL;
+}
 #endif
@@ -183,10 +183,179 @@ int dm_init(bool of_live)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * struct dm_lazy_dev - a device whose binding has been deferred
+ *
+ * @sibling_node: Node in the list of deferred devices for its uclass
+ * @node: Device tree node to bind (if @info is NULL)
+ * @info: Platform data to bind, or NULL for a device tree node
+ */
+struct dm_lazy_dev {
+	struct list_head sibling_node;
+	ofnode node;
+	const struct driver_info *info;
+};
+
+/*
+ * Deferred devices, one list for each uclass so that uclass_get() does not
+ * have to search. Only added to after relocation, so this does not need to
+ * live in gd. A list is set up when the first device is added to it.
+ */
+static struct list_head dm_lazy_heads[UCLASS_COUNT];
+
+static int dm_lazy_add(enum uclass_id id, ofnode node,
+		       const struct driver_info *info)
+{
+	struct list_head *head = &dm_lazy_heads[id];
+	struct dm_lazy_dev *lazy;
+
+	lazy = calloc(1, sizeof(*lazy));
+	if (!lazy)
+		return -ENOMEM;
+	lazy->node = node;
+	lazy->info = info;
+	if (!head->next)
+		INIT_LIST_HEAD(head);
+	list_add_tail(&lazy->sibling_node, head);
+
+	return 0;
+}
+
+int dm_lazy_bind_uclass(enum uclass_id id)
+{
+	struct list_head *head;
+	struct dm_lazy_dev *lazy;
+	struct udevice *dev;
+	int ret = 0, err;
+
+	if (id < 0 || id >= UCLASS_COUNT)
+		return 0;
+	head = &dm_lazy_heads[id];
+	if (!head->next)
+		return 0;
+
+	/*
+	 * Binding a device looks up its uclass and may come back here, so
+	 * take each entry off the list before binding it.
+	 */
+	while (!list_empty(head)) {
+		lazy = list_first_entry(head, struct dm_lazy_dev,
+					sibling_node);
+		list_del(&lazy->sibling_node);
+		if (lazy->info)
+			err = device_bind_by_name(DM_ROOT_NON_CONST, false,
+						  lazy->info, &dev);
+		else
+			err = lists_bind_fdt(DM_ROOT_NON_CONST, lazy->node,
+					     NULL);
+		free(lazy);
+		if (err && !ret)
+			ret = err;
+	}
+
+	return ret;
+}
+
+int dm_lazy_count(void)
+{
+	int count = 0;
+	int id;
+
+	for (id = 0; id < UCLASS_COUNT; id++) {
+		if (dm_lazy_heads[id].next)
+			count += list_count_items(&dm_lazy_heads[id]);
+	}
+
+	return count;
+}
+
+static void dm_lazy_free_all(void)
+{
+	struct dm_lazy_dev *lazy, *next;
+	int id;
+
+	for (id = 0; id < UCLASS_COUNT; id++) {
+		if (!dm_lazy_heads[id].next)
+			continue;
+		list_for_each_entry_safe(lazy, next, &dm_lazy_heads[id],
+					 sibling_node) {
+			list_del(&lazy->sibling_node);
+			free(lazy);
+		}
+	}
+}
+
+/*
+ * Defer binding of a top-level device until its uclass is used. Devices
+ * needed before relocation are assumed to be needed early after it too,
+ * so they are bound straight away.
+ *
+ * Child devices are only bound when their parent is, and a lookup in the
+ * child's uclass would not find a deferred parent. So buses, and any other
+ * node with devices below it, are bound straight away as well.
+ */
+static bool dm_lazy_defer_node(struct udevice *parent, ofnode node,
+			       bool pre_reloc_only)
+{
+	struct driver *drv;
+	ofnode subnode;
+
+	if (pre_reloc_only || parent != gd->dm_root || ofnode_pre_reloc(node))
+		return false;
+	drv = lists_find_fdt_driver(node);
+	if (!drv || drv->id == UCLASS_SIMPLE_BUS)
+		return false;
+	ofnode_for_each_subnode(subnode, node) {
+		if (ofnode_get_property(subnode, "compatible", NULL))
+			return false;
+	}
+
+	return !dm_lazy_add(drv->id, node, NULL);
+}
+
+static int dm_lazy_scan_platdata(void)
+{
+	struct driver_info *info =
+		ll_entry_start(struct driver_info, driver_info);
+	const int n_ents = ll_entry_count(struct driver_info, driver_info);
+	struct driver_info *entry;
+	struct udevice *dev;
+	struct driver *drv;
+	int ret;
+
+	for (entry = info; entry != info + n_ents; entry++) {
+		drv = lists_driver_lookup_name(entry->name);
+		if (drv && !(drv->flags & DM_FLAG_PRE_RELOC)) {
+			ret = dm_lazy_add(drv->id, ofnode_null(), entry);
+			if (ret)
+				return ret;
+			continue;
+		}
+		ret = device_bind_by_name(DM_ROOT_NON_CONST, false, entry, &dev);
+		if (ret)
+			dm_warn("No match for driver '%s'\n", entry->name);
+	}
+
+	return 0;
+}
+#else
+static inline bool dm_lazy_defer_node(struct udevice *parent, ofnode node,
+				      bool pre_reloc_only)
+{
+	return false;
+}
+
+static inline void dm_lazy_free_all(void)
+{
+}
+#endif /* DM_LAZY_BIND */
+
 int dm_uninit(void)
 {
 	device_remove(dm_root(), DM_REMOVE_NORMAL);
 	device_unbind(dm_root());
+	dm_lazy_free_all();
 
 	return 0;
 }
@@ -204,6 +373,10 @@ int dm_scan_platdata(bool pre_reloc_only)
 {
 	int ret;
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+	if (!pre_reloc_only)
+		return dm_lazy_scan_platdata();
+#endif
 	ret = lists_bind_drivers(DM_ROOT_NON_CONST, pre_reloc_only);
 	if (ret == -ENOENT) {
 		dm_warn("Some drivers were not found\n");
@@ -229,6 +402,9 @@ static int dm_scan_fdt_live(struct udevice *parent,
 			pr_debug("   - ignoring disabled device\n");
 			continue;
 		}
+		if (dm_lazy_defer_node(parent, np_to_ofnode(np),
+				       pre_reloc_only))
+			continue;
 		err = lists_bind_fdt(parent, np_to_ofnode(np), NULL);
 		if (err && !ret) {
 			ret = err;
@@ -283,6 +459,9 @@ static int dm_scan_fdt_node(struct udevice *parent, const void *blob,
 			pr_debug("   - ignoring disabled device\n");
 			continue;
 		}
+		if (dm_lazy_defer_node(parent, offset_to_ofnode(offset),
+				       pre_reloc_only))
+			continue;
 		err = lists_bind_fdt(parent, offset_to_ofnode(offset), NULL);
 		if (err && !ret) {
 			ret = err;
@@ -13,6 +13,7 @@
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
+#include <dm/root.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -138,13 +139,20 @@ int uclass_destroy(struct uclass *uc)
 int uclass_get(enum uclass_id id, struct uclass **ucp)
 {
 	struct uclass *uc;
+	int ret;
 
 	*ucp = NULL;
 	uc = uclass_find(id);
-	if (!uc)
-		return uclass_add(id, ucp);
+	if (!uc) {
+		ret = uclass_add(id, &uc);
+		if (ret)
+			return ret;
+	}
 	*ucp = uc;
 
+	/* Errors are reported when binding; the uclass itself is fine */
+	dm_lazy_bind_uclass(id);
+
 	return 0;
 }
 
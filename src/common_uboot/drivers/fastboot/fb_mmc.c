@@ -96,6 +96,23 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+static lbaint_t fb_mmc_sparse_discard(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+	struct fb_mmc_sparse *sparse = info->priv;
+	struct mmc *mmc = find_mmc_device(CONFIG_FASTBOOT_FLASH_MMC_DEV);
+	lbaint_t grp_size = mmc->erase_grp_size;
+	lbaint_t start, end;
+
+	/* Align blocks to erase group size to avoid erasing other data */
+	start = (blk + grp_size - 1) & ~(grp_size - 1);
+	end = (blk + blkcnt) & ~(grp_size - 1);
+	if (end <= start)
+		return 0;
+
+	return fb_mmc_blk_write(sparse->dev_desc, start, end - start, NULL);
+}
+
 static void write_raw_image(struct blk_desc *dev_desc, disk_partition_t *info,
 		const char *part_name, void *buffer,
 		u32 download_bytes, char *response)
@@ -412,6 +429,7 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 		sparse.size = info.size;
 		sparse.write = fb_mmc_sparse_write;
 		sparse.reserve = fb_mmc_sparse_reserve;
+		sparse.discard = fb_mmc_sparse_discard;
 		sparse.mssg = fastboot_fail;
 
 		printf("Flashing sparse image at offset " LBAFU "\n",
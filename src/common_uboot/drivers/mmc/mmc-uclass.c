@@ -186,6 +186,7 @@ struct mmc *find_mmc_device(int dev_num)
 	struct udevice *dev, *mmc_dev;
 	int ret;
 
+	mmc_wait_deferred_init();
 	ret = blk_find_device(IF_TYPE_MMC, dev_num, &dev);
 
 	if (ret) {
@@ -204,6 +205,8 @@ struct mmc *find_mmc_device(int dev_num)
 
 int get_mmc_num(void)
 {
+	mmc_wait_deferred_init();
+
 	return max((blk_find_max_devnum(IF_TYPE_MMC) + 1), 0);
 }
 
@@ -254,6 +257,7 @@ void print_mmc_devices(char separator)
 	char *mmc_type;
 	bool first = true;
 
+	mmc_wait_deferred_init();
 	for (uclass_first_device(UCLASS_MMC, &dev);
 	     dev;
 	     uclass_next_device(&dev), first = false) {
@@ -39,6 +39,7 @@ struct mmc *find_mmc_device(int dev_num)
 	struct mmc *m;
 	struct list_head *entry;
 
+	mmc_wait_deferred_init();
 	list_for_each(entry, &mmc_devices) {
 		m = list_entry(entry, struct mmc, link);
 
@@ -65,6 +66,8 @@ struct blk_desc *mmc_get_blk_desc(struct mmc *mmc)
 
 int get_mmc_num(void)
 {
+	mmc_wait_deferred_init();
+
 	return cur_dev_num;
 }
 
@@ -105,6 +108,7 @@ void print_mmc_devices(char separator)
 	struct list_head *entry;
 	char *mmc_type;
 
+	mmc_wait_deferred_init();
 	list_for_each(entry, &mmc_devices) {
 		m = list_entry(entry, struct mmc, link);
 
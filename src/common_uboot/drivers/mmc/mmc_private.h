@@ -9,6 +9,7 @@
 #ifndef _MMC_PRIVATE_H_
 #define _MMC_PRIVATE_H_
 
+#include <initcall.h>
 #include <mmc.h>
 
 extern int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
@@ -134,4 +135,12 @@ int mmc_switch_part(struct mmc *mmc, unsigned int part_num);
  */
 int mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value);
 
+/* Finish setting up MMC if board_init_r() deferred it (INITCALL_ASYNC) */
+static inline void mmc_wait_deferred_init(void)
+{
+#ifndef CONFIG_SPL_BUILD
+	initcall_async_wait_name("initr_mmc");
+#endif
+}
+
 #endif /* _MMC_PRIVATE_H_ */
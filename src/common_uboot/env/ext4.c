@@ -61,7 +61,7 @@ static int env_ext4_save(void)
 
 	err = ext4fs_write(CONFIG_ENV_EXT4_FILE, (void *)&env_new,
 			   sizeof(env_t));
-	ext4fs_close();
+	ext4fs_umount();
 
 	if (err == -1) {
 		printf("\n** Unable to write \"%s\" from %s%d:%d **\n",
@@ -107,7 +107,7 @@ static int env_ext4_load(void)
 
 	err = ext4_read_file(CONFIG_ENV_EXT4_FILE, buf, 0, CONFIG_ENV_SIZE,
 			     &off);
-	ext4fs_close();
+	ext4fs_umount();
 
 	if (err == -1) {
 		printf("\n** Unable to read \"%s\" from %s%d:%d **\n",
@@ -45,6 +45,205 @@ int ext4fs_indir3_blkno = -1;
 struct ext2_inode *g_parent_inode;
 static int symlinknest;
 
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+/* Number of inodes, group descriptors and extent blocks cached */
+#define EXT4_CACHE_INODES	16
+#define EXT4_CACHE_GROUPS	16
+#define EXT4_CACHE_EXTENTS	4
+
+/**
+ * struct ext4fs_mount_cache - what is kept while a filesystem is mounted
+ *
+ * The caches are filled as the filesystem is read and emptied whenever the
+ * block device changes (see blk_mark_changed()). With a mount session, the
+ * mount and its caches are kept by ext4fs_close() and used again by the next
+ * ext4fs_probe() on the same partition.
+ *
+ * @desc:		Block device of the kept mount, or NULL if none
+ * @hwpart:		Hardware partition of @desc
+ * @start:		Start block of the partition
+ * @size:		Size of the partition in blocks
+ * @change_gen:		Value of the device's change_gen when the caches
+ *			were last checked
+ * @inode_no:		Number of each cached inode
+ * @inodes:		Cached inodes
+ * @inode_count:	Number of entries of @inodes in use
+ * @next_inode:		Next entry of @inodes to replace
+ * @group_no:		Number of each cached group descriptor
+ * @groups:		Cached group descriptors
+ * @group_count:	Number of entries of @groups in use
+ * @next_group:		Next entry of @groups to replace
+ * @extent_blkno:	Block number of each cached extent block, 0 if unused
+ * @extents:		Cached extent tree blocks (allocated)
+ * @next_extent:	Next entry of @extents to replace
+ */
+struct ext4fs_mount_cache {
+	struct blk_desc *desc;
+	int hwpart;
+	lbaint_t start;
+	lbaint_t size;
+	unsigned int change_gen;
+	int inode_no[EXT4_CACHE_INODES];
+	struct ext2_inode inodes[EXT4_CACHE_INODES];
+	int inode_count;
+	int next_inode;
+	int group_no[EXT4_CACHE_GROUPS];
+	struct ext2_block_group groups[EXT4_CACHE_GROUPS];
+	int group_count;
+	int next_group;
+	unsigned long long extent_blkno[EXT4_CACHE_EXTENTS];
+	char *extents[EXT4_CACHE_EXTENTS];
+	int next_extent;
+};
+
+static struct ext4fs_mount_cache ext4fs_mcache;
+
+static void ext4fs_cache_flush(void)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+	int i;
+
+	mc->inode_count = 0;
+	mc->group_count = 0;
+	for (i = 0; i < EXT4_CACHE_EXTENTS; i++) {
+		free(mc->extents[i]);
+		mc->extents[i] = NULL;
+		mc->extent_blkno[i] = 0;
+	}
+}
+
+/* Start filling the caches from the current device */
+static void ext4fs_cache_reset(void)
+{
+	ext4fs_cache_flush();
+	ext4fs_mcache.change_gen = get_fs()->dev_desc->change_gen;
+}
+
+/*
+ * Empty the caches if the device changed since they were filled. The kept
+ * mount may be stale as well, so ext4fs_close() must then drop it.
+ */
+static void ext4fs_cache_check(void)
+{
+	if (ext4fs_mcache.change_gen != get_fs()->dev_desc->change_gen) {
+		ext4fs_mcache.desc = NULL;
+		ext4fs_cache_reset();
+	}
+}
+
+static bool ext4fs_cache_get_inode(int ino, struct ext2_inode *inode)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+	int i;
+
+	ext4fs_cache_check();
+	for (i = 0; i < mc->inode_count; i++) {
+		if (mc->inode_no[i] == ino) {
+			memcpy(inode, &mc->inodes[i], sizeof(*inode));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void ext4fs_cache_add_inode(int ino, const struct ext2_inode *inode)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+
+	mc->inode_no[mc->next_inode] = ino;
+	memcpy(&mc->inodes[mc->next_inode], inode, sizeof(*inode));
+	mc->next_inode = (mc->next_inode + 1) % EXT4_CACHE_INODES;
+	if (mc->inode_count < EXT4_CACHE_INODES)
+		mc->inode_count++;
+}
+
+static bool ext4fs_cache_get_group(int group, struct ext2_block_group *blkgrp)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+	int i;
+
+	ext4fs_cache_check();
+	for (i = 0; i < mc->group_count; i++) {
+		if (mc->group_no[i] == group) {
+			memcpy(blkgrp, &mc->groups[i], sizeof(*blkgrp));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void ext4fs_cache_add_group(int group,
+				   const struct ext2_block_group *blkgrp)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+
+	mc->group_no[mc->next_group] = group;
+	memcpy(&mc->groups[mc->next_group], blkgrp, sizeof(*blkgrp));
+	mc->next_group = (mc->next_group + 1) % EXT4_CACHE_GROUPS;
+	if (mc->group_count < EXT4_CACHE_GROUPS)
+		mc->group_count++;
+}
+
+/**
+ * ext4fs_cache_read_extent() - read an extent tree block through the cache
+ *
+ * @block:	Filesystem block number
+ * @log2_blksz:	Log2 of the number of device blocks per filesystem block
+ * @blksz:	Filesystem block size
+ * @return pointer to the cached block, or NULL if it cannot be cached or
+ * read
+ */
+static char *ext4fs_cache_read_extent(unsigned long long block,
+				      int log2_blksz, int blksz)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+	int i, slot;
+
+	ext4fs_cache_check();
+	for (i = 0; i < EXT4_CACHE_EXTENTS; i++) {
+		if (mc->extents[i] && mc->extent_blkno[i] == block)
+			return mc->extents[i];
+	}
+
+	slot = mc->next_extent;
+	if (!mc->extents[slot]) {
+		mc->extents[slot] = malloc(blksz);
+		if (!mc->extents[slot])
+			return NULL;
+	}
+	mc->extent_blkno[slot] = 0;
+	if (!ext4fs_devread((lbaint_t)block << log2_blksz, 0, blksz,
+			    mc->extents[slot]))
+		return NULL;
+	mc->extent_blkno[slot] = block;
+	mc->next_extent = (slot + 1) % EXT4_CACHE_EXTENTS;
+
+	return mc->extents[slot];
+}
+
+bool ext4fs_session_reuse(struct blk_desc *desc, disk_partition_t *part)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+
+	return ext4fs_root && mc->desc == desc && mc->hwpart == desc->hwpart &&
+		mc->start == part->start && mc->size == part->size &&
+		mc->change_gen == desc->change_gen;
+}
+
+void ext4fs_session_start(struct blk_desc *desc, disk_partition_t *part)
+{
+	struct ext4fs_mount_cache *mc = &ext4fs_mcache;
+
+	mc->desc = desc;
+	mc->hwpart = desc->hwpart;
+	mc->start = part->start;
+	mc->size = part->size;
+	mc->change_gen = desc->change_gen;
+}
+#endif
+
 #if defined(CONFIG_EXT4_WRITE)
 struct ext2_block_group *ext4fs_get_group_descriptor
 	(const struct ext_filesystem *fs, uint32_t bg_idx)
@@ -302,6 +501,40 @@ static int _get_new_blk_no(unsigned char *buffer)
 	return -1;
 }
 
+/*
+ * Called before a bitmap is changed. The first change since ext4fs_init()
+ * saves the bitmap as it is on disk for the journal, and marks it so that
+ * ext4fs_update() writes it back. Bitmaps which did not change are not
+ * written at all.
+ */
+static void ext4fs_mark_block_bmap(int index)
+{
+	struct ext_filesystem *fs = get_fs();
+	struct ext2_block_group *bgd;
+
+	if (fs->blk_bmap_dirty[index])
+		return;
+	bgd = ext4fs_get_group_descriptor(fs, index);
+	if (ext4fs_log_journal((char *)fs->blk_bmaps[index],
+			       ext4fs_bg_get_block_id(bgd, fs)))
+		debug("cannot journal block bitmap %d\n", index);
+	fs->blk_bmap_dirty[index] = 1;
+}
+
+static void ext4fs_mark_inode_bmap(int index)
+{
+	struct ext_filesystem *fs = get_fs();
+	struct ext2_block_group *bgd;
+
+	if (fs->inode_bmap_dirty[index])
+		return;
+	bgd = ext4fs_get_group_descriptor(fs, index);
+	if (ext4fs_log_journal((char *)fs->inode_bmaps[index],
+			       ext4fs_bg_get_inode_id(bgd, fs)))
+		debug("cannot journal inode bitmap %d\n", index);
+	fs->inode_bmap_dirty[index] = 1;
+}
+
 int ext4fs_set_block_bmap(long int blockno, unsigned char *buffer, int index)
 {
 	int i, remainder, status;
@@ -319,6 +552,7 @@ int ext4fs_set_block_bmap(long int blockno, unsigned char *buffer, int index)
 		if (status)
 			return -1;
 
+		ext4fs_mark_block_bmap(index);
 		*ptr = *ptr | operand;
 		return 0;
 	} else {
@@ -333,6 +567,7 @@ int ext4fs_set_block_bmap(long int blockno, unsigned char *buffer, int index)
 		if (status)
 			return -1;
 
+		ext4fs_mark_block_bmap(index);
 		*ptr = *ptr | operand;
 		return 0;
 	}
@@ -352,8 +587,10 @@ void ext4fs_reset_block_bmap(long int blockno, unsigned char *buffer, int index)
 		ptr = ptr + i;
 		operand = (1 << remainder);
 		status = *ptr & operand;
-		if (status)
+		if (status) {
+			ext4fs_mark_block_bmap(index);
 			*ptr = *ptr & ~(operand);
+		}
 	} else {
 		if (remainder == 0) {
 			ptr = ptr + i - 1;
@@ -363,8 +600,10 @@ void ext4fs_reset_block_bmap(long int blockno, unsigned char *buffer, int index)
 			operand = (1 << (remainder - 1));
 		}
 		status = *ptr & operand;
-		if (status)
+		if (status) {
+			ext4fs_mark_block_bmap(index);
 			*ptr = *ptr & ~(operand);
+		}
 	}
 }
 
@@ -388,6 +627,7 @@ int ext4fs_set_inode_bmap(int inode_no, unsigned char *buffer, int index)
 	if (status)
 		return -1;
 
+	ext4fs_mark_inode_bmap(index);
 	*ptr = *ptr | operand;
 
 	return 0;
@@ -410,8 +650,10 @@ void ext4fs_reset_inode_bmap(int inode_no, unsigned char *buffer, int index)
 		operand = (1 << (remainder - 1));
 	}
 	status = *ptr & operand;
-	if (status)
+	if (status) {
+		ext4fs_mark_inode_bmap(index);
 		*ptr = *ptr & ~(operand);
+	}
 }
 
 uint16_t ext4fs_checksum_update(uint32_t i)
@@ -958,16 +1200,10 @@ int ext4fs_filename_unlink(char *filename)
 uint32_t ext4fs_get_new_blk_no(void)
 {
 	short i;
-	short status;
 	int remainder;
 	unsigned int bg_idx;
-	static int prev_bg_bitmap_index = -1;
 	unsigned int blk_per_grp = le32_to_cpu(ext4fs_root->sblock.blocks_per_group);
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	char *zero_buffer = zalloc(fs->blksz);
-	if (!journal_buffer || !zero_buffer)
-		goto fail;
 
 	if (fs->first_pass_bbmap == 0) {
 		for (i = 0; i < fs->no_blkgrp; i++) {
@@ -975,16 +1211,13 @@ uint32_t ext4fs_get_new_blk_no(void)
 			bgd = ext4fs_get_group_descriptor(fs, i);
 			if (ext4fs_bg_get_free_blocks(bgd, fs)) {
 				uint16_t bg_flags = ext4fs_bg_get_flags(bgd);
-				uint64_t b_bitmap_blk =
-					ext4fs_bg_get_block_id(bgd, fs);
 				if (bg_flags & EXT4_BG_BLOCK_UNINIT) {
-					memcpy(fs->blk_bmaps[i], zero_buffer,
+					memset(fs->blk_bmaps[i], '\0',
 					       fs->blksz);
-					put_ext4(b_bitmap_blk * fs->blksz,
-						 fs->blk_bmaps[i], fs->blksz);
 					bg_flags &= ~EXT4_BG_BLOCK_UNINIT;
 					ext4fs_bg_set_flags(bgd, bg_flags);
 				}
+				ext4fs_mark_block_bmap(i);
 				fs->curr_blkno =
 				    _get_new_blk_no(fs->blk_bmaps[i]);
 				if (fs->curr_blkno == -1)
@@ -995,15 +1228,6 @@ uint32_t ext4fs_get_new_blk_no(void)
 				fs->first_pass_bbmap++;
 				ext4fs_bg_free_blocks_dec(bgd, fs);
 				ext4fs_sb_free_blocks_dec(fs->sb);
-				status = ext4fs_devread(b_bitmap_blk *
-							fs->sect_perblk,
-							0, fs->blksz,
-							journal_buffer);
-				if (status == 0)
-					goto fail;
-				if (ext4fs_log_journal(journal_buffer,
-						       b_bitmap_blk))
-					goto fail;
 				goto success;
 			} else {
 				debug("no space left on block group %d\n", i);
@@ -1040,11 +1264,8 @@ restart:
 		}
 
 		uint16_t bg_flags = ext4fs_bg_get_flags(bgd);
-		uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
 		if (bg_flags & EXT4_BG_BLOCK_UNINIT) {
-			memcpy(fs->blk_bmaps[bg_idx], zero_buffer, fs->blksz);
-			put_ext4(b_bitmap_blk * fs->blksz,
-				 zero_buffer, fs->blksz);
+			memset(fs->blk_bmaps[bg_idx], '\0', fs->blksz);
 			bg_flags &= ~EXT4_BG_BLOCK_UNINIT;
 			ext4fs_bg_set_flags(bgd, bg_flags);
 		}
@@ -1057,45 +1278,22 @@ restart:
 			goto restart;
 		}
 
-		/* journal backup */
-		if (prev_bg_bitmap_index != bg_idx) {
-			status = ext4fs_devread(b_bitmap_blk * fs->sect_perblk,
-						0, fs->blksz, journal_buffer);
-			if (status == 0)
-				goto fail;
-			if (ext4fs_log_journal(journal_buffer, b_bitmap_blk))
-				goto fail;
-
-			prev_bg_bitmap_index = bg_idx;
-		}
 		ext4fs_bg_free_blocks_dec(bgd, fs);
 		ext4fs_sb_free_blocks_dec(fs->sb);
 		goto success;
 	}
 success:
-	free(journal_buffer);
-	free(zero_buffer);
-
 	return fs->curr_blkno;
 fail:
-	free(journal_buffer);
-	free(zero_buffer);
-
 	return -1;
 }
 
 int ext4fs_get_new_inode_no(void)
 {
 	short i;
-	short status;
 	unsigned int ibmap_idx;
-	static int prev_inode_bitmap_index = -1;
 	unsigned int inodes_per_grp = le32_to_cpu(ext4fs_root->sblock.inodes_per_group);
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	char *zero_buffer = zalloc(fs->blksz);
-	if (!journal_buffer || !zero_buffer)
-		goto fail;
 	int has_gdt_chksum = le32_to_cpu(fs->sb->feature_ro_compat) &
 		EXT4_FEATURE_RO_COMPAT_GDT_CSUM ? 1 : 0;
 
@@ -1107,18 +1305,15 @@ int ext4fs_get_new_inode_no(void)
 			free_inodes = ext4fs_bg_get_free_inodes(bgd, fs);
 			if (free_inodes) {
 				uint16_t bg_flags = ext4fs_bg_get_flags(bgd);
-				uint64_t i_bitmap_blk =
-					ext4fs_bg_get_inode_id(bgd, fs);
 				if (has_gdt_chksum)
 					bgd->bg_itable_unused = free_inodes;
 				if (bg_flags & EXT4_BG_INODE_UNINIT) {
-					put_ext4(i_bitmap_blk * fs->blksz,
-						 zero_buffer, fs->blksz);
 					bg_flags &= ~EXT4_BG_INODE_UNINIT;
 					ext4fs_bg_set_flags(bgd, bg_flags);
-					memcpy(fs->inode_bmaps[i],
-					       zero_buffer, fs->blksz);
+					memset(fs->inode_bmaps[i], '\0',
+					       fs->blksz);
 				}
+				ext4fs_mark_inode_bmap(i);
 				fs->curr_inode_no =
 				    _get_new_inode_no(fs->inode_bmaps[i]);
 				if (fs->curr_inode_no == -1)
@@ -1131,15 +1326,6 @@ int ext4fs_get_new_inode_no(void)
 				if (has_gdt_chksum)
 					ext4fs_bg_itable_unused_dec(bgd, fs);
 				ext4fs_sb_free_inodes_dec(fs->sb);
-				status = ext4fs_devread(i_bitmap_blk *
-							fs->sect_perblk,
-							0, fs->blksz,
-							journal_buffer);
-				if (status == 0)
-					goto fail;
-				if (ext4fs_log_journal(journal_buffer,
-						       i_bitmap_blk))
-					goto fail;
 				goto success;
 			} else
 				debug("no inode left on block group %d\n", i);
@@ -1153,15 +1339,11 @@ restart:
 		struct ext2_block_group *bgd =
 			ext4fs_get_group_descriptor(fs, ibmap_idx);
 		uint16_t bg_flags = ext4fs_bg_get_flags(bgd);
-		uint64_t i_bitmap_blk = ext4fs_bg_get_inode_id(bgd, fs);
 
 		if (bg_flags & EXT4_BG_INODE_UNINIT) {
-			put_ext4(i_bitmap_blk * fs->blksz,
-				 zero_buffer, fs->blksz);
 			bg_flags &= ~EXT4_BG_INODE_UNINIT;
 			ext4fs_bg_set_flags(bgd, bg_flags);
-			memcpy(fs->inode_bmaps[ibmap_idx], zero_buffer,
-				fs->blksz);
+			memset(fs->inode_bmaps[ibmap_idx], '\0', fs->blksz);
 		}
 
 		if (ext4fs_set_inode_bmap(fs->curr_inode_no,
@@ -1172,17 +1354,6 @@ restart:
 			goto restart;
 		}
 
-		/* journal backup */
-		if (prev_inode_bitmap_index != ibmap_idx) {
-			status = ext4fs_devread(i_bitmap_blk * fs->sect_perblk,
-						0, fs->blksz, journal_buffer);
-			if (status == 0)
-				goto fail;
-			if (ext4fs_log_journal(journal_buffer,
-						le32_to_cpu(bgd->inode_id)))
-				goto fail;
-			prev_inode_bitmap_index = ibmap_idx;
-		}
 		ext4fs_bg_free_inodes_dec(bgd, fs);
 		if (has_gdt_chksum)
 			bgd->bg_itable_unused = bgd->free_inodes;
@@ -1191,14 +1362,8 @@ restart:
 	}
 
 success:
-	free(journal_buffer);
-	free(zero_buffer);
-
 	return fs->curr_inode_no;
 fail:
-	free(journal_buffer);
-	free(zero_buffer);
-
 	return -1;
 
 }
@@ -1520,6 +1685,229 @@ void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 	*total_no_of_block += no_blks_reqd;
 }
 
+/**
+ * ext4fs_blocks_needed() - work out the most blocks a new file can take
+ *
+ * This is the data plus the largest number of indirect or extent tree
+ * blocks that ext4fs_allocate_blocks() or ext4fs_allocate_extents() may
+ * need for it, i.e. with every data block in an extent of its own.
+ *
+ * @data_blocks:	Number of data blocks in the file
+ * @extents:		true if the file is to be written as extents
+ * @return number of blocks
+ */
+uint32_t ext4fs_blocks_needed(uint32_t data_blocks, bool extents)
+{
+	struct ext_filesystem *fs = get_fs();
+	uint32_t per_blk = fs->blksz / sizeof(unsigned int);
+	uint32_t total = data_blocks;
+	uint32_t count, n;
+
+	if (extents) {
+		n = (fs->blksz - sizeof(struct ext4_extent_header)) /
+			sizeof(struct ext4_extent);
+		for (count = data_blocks; count > EXT4_EXT_INODE_MAX;) {
+			count = DIV_ROUND_UP(count, n);
+			total += count;
+		}
+
+		return total;
+	}
+
+	if (data_blocks <= INDIRECT_BLOCKS)
+		return total;
+	count = data_blocks - INDIRECT_BLOCKS;
+	/* single indirect */
+	total++;
+	if (count <= per_blk)
+		return total;
+	count -= per_blk;
+	/* double indirect */
+	n = min(count, per_blk * per_blk);
+	total += 1 + DIV_ROUND_UP(n, per_blk);
+	if (count <= n)
+		return total;
+	count -= n;
+	/* triple indirect */
+	total += 1 + DIV_ROUND_UP(count, per_blk * per_blk) +
+		DIV_ROUND_UP(count, per_blk);
+
+	return total;
+}
+
+/*
+ * Write one node of an extent tree, holding @count extents (at depth 0) or
+ * index entries, and point @index at it
+ */
+static int ext4fs_put_extent_node(struct ext4_extent_idx *index,
+				  const struct ext4_extent_idx *entries,
+				  int count, int depth, uint32_t *blknrp)
+{
+	struct ext_filesystem *fs = get_fs();
+	struct ext4_extent_header *eh;
+	uint32_t blknr;
+
+	eh = zalloc(fs->blksz);
+	if (!eh)
+		return -ENOMEM;
+	blknr = ext4fs_get_new_blk_no();
+	if (blknr == -1) {
+		free(eh);
+		return -ENOSPC;
+	}
+	eh->eh_magic = cpu_to_le16(EXT4_EXT_MAGIC);
+	eh->eh_entries = cpu_to_le16(count);
+	eh->eh_max = cpu_to_le16((fs->blksz - sizeof(*eh)) /
+				 sizeof(struct ext4_extent_idx));
+	eh->eh_depth = cpu_to_le16(depth);
+	memcpy(eh + 1, entries, count * sizeof(*entries));
+	put_ext4((uint64_t)blknr * fs->blksz, eh, fs->blksz);
+	free(eh);
+
+	index->ei_block = entries->ei_block;
+	index->ei_leaf_lo = cpu_to_le32(blknr);
+	index->ei_leaf_hi = 0;
+	index->ei_unused = 0;
+	*blknrp = blknr;
+
+	return 0;
+}
+
+/*
+ * Give back the blocks taken by ext4fs_allocate_extents() when it fails:
+ * the data blocks in @extents and the @tree_count blocks in @tree
+ */
+static void ext4fs_free_extents(const struct ext4_extent *extents, int count,
+				const uint32_t *tree, int tree_count)
+{
+	int i, j;
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < le16_to_cpu(extents[i].ee_len); j++)
+			ext4fs_free_block(le32_to_cpu(extents[i].ee_start_lo) +
+					  j);
+	}
+	for (i = 0; i < tree_count; i++)
+		ext4fs_free_block(tree[i]);
+}
+
+/**
+ * ext4fs_allocate_extents() - allocate the blocks of a file as extents
+ *
+ * Blocks are taken from the bitmaps in order and merged into extents as long
+ * as they are contiguous. Up to EXT4_EXT_INODE_MAX extents are held in the
+ * inode itself. More need a tree, which is built from the leaves up and made
+ * as deep as needed for its top level to fit in the inode. The tree blocks
+ * are allocated after the data. On error every block taken is given back.
+ *
+ * @file_inode:		Inode to fill in
+ * @total_remaining_blocks: Number of data blocks to allocate
+ * @total_no_of_block:	Number of blocks used by the file, updated to add
+ *			any tree blocks
+ * @extentsp:		Returns the list of extents, which the caller must
+ *			free
+ * @return number of extents, or -ve on error
+ */
+int ext4fs_allocate_extents(struct ext2_inode *file_inode,
+			    unsigned int total_remaining_blocks,
+			    unsigned int *total_no_of_block,
+			    struct ext4_extent **extentsp)
+{
+	struct ext_filesystem *fs = get_fs();
+	struct ext4_extent_header *eh;
+	struct ext4_extent_idx *level = NULL;
+	struct ext4_extent *extents = NULL, *ext = NULL;
+	int per_node = (fs->blksz - sizeof(*eh)) / sizeof(*ext);
+	uint32_t *tree = NULL;
+	int count = 0, alloc = 0, tree_count = 0;
+	int entries, nodes, node, depth;
+	uint32_t blknr, i;
+	int ret;
+
+	for (i = 0; i < total_remaining_blocks; i++) {
+		if (count == alloc) {
+			alloc = alloc ? alloc * 2 : 16;
+			ext = realloc(extents, alloc * sizeof(*ext));
+			if (!ext) {
+				ret = -ENOMEM;
+				goto fail;
+			}
+			extents = ext;
+			ext = count ? &extents[count - 1] : NULL;
+		}
+		blknr = ext4fs_get_new_blk_no();
+		if (blknr == -1) {
+			printf("no block left to assign\n");
+			ret = -ENOSPC;
+			goto fail;
+		}
+		if (ext && le16_to_cpu(ext->ee_len) < EXT4_EXT_INIT_MAX_LEN &&
+		    le32_to_cpu(ext->ee_start_lo) +
+		    le16_to_cpu(ext->ee_len) == blknr) {
+			ext->ee_len = cpu_to_le16(le16_to_cpu(ext->ee_len) + 1);
+			continue;
+		}
+		ext = &extents[count++];
+		ext->ee_block = cpu_to_le32(i);
+		ext->ee_len = cpu_to_le16(1);
+		ext->ee_start_hi = 0;
+		ext->ee_start_lo = cpu_to_le32(blknr);
+	}
+	debug("%u blocks in %d extents\n", total_remaining_blocks, count);
+
+	eh = (struct ext4_extent_header *)file_inode->b.blocks.dir_blocks;
+	eh->eh_magic = cpu_to_le16(EXT4_EXT_MAGIC);
+	eh->eh_max = cpu_to_le16(EXT4_EXT_INODE_MAX);
+	entries = count;
+	depth = 0;
+	if (count > EXT4_EXT_INODE_MAX) {
+		/* Each level is written over the one below it in @level */
+		level = malloc(count * sizeof(*level));
+		tree = malloc((ext4fs_blocks_needed(count, true) - count) *
+			      sizeof(*tree));
+		if (!level || !tree) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+		memcpy(level, extents, count * sizeof(*level));
+	}
+	for (; entries > EXT4_EXT_INODE_MAX; depth++) {
+		nodes = DIV_ROUND_UP(entries, per_node);
+		for (node = 0; node < nodes; node++) {
+			ret = ext4fs_put_extent_node(&level[node],
+					&level[node * per_node],
+					min(entries - node * per_node,
+					    per_node),
+					depth, &tree[tree_count]);
+			if (ret)
+				goto fail;
+			tree_count++;
+		}
+		entries = nodes;
+	}
+	eh->eh_entries = cpu_to_le16(entries);
+	eh->eh_depth = cpu_to_le16(depth);
+	memcpy(eh + 1, level ? (void *)level : (void *)extents,
+	       entries * sizeof(*ext));
+	*total_no_of_block += tree_count;
+	debug("extent tree of depth %d with %d blocks\n", depth, tree_count);
+
+	file_inode->flags = cpu_to_le32(le32_to_cpu(file_inode->flags) |
+					EXT4_EXTENTS_FL);
+	free(level);
+	free(tree);
+	*extentsp = extents;
+
+	return count;
+fail:
+	ext4fs_free_extents(extents, count, tree, tree_count);
+	free(level);
+	free(tree);
+	free(extents);
+
+	return ret;
+}
+
 #endif
 
 static struct ext4_extent_header *ext4fs_get_extent_block
@@ -1530,6 +1918,9 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 	struct ext4_extent_idx *index;
 	unsigned long long block;
 	int blksz = EXT2_BLOCK_SIZE(data);
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	char *cached;
+#endif
 	int i;
 
 	while (1) {
@@ -1553,6 +1944,13 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 		block = le16_to_cpu(index[i].ei_leaf_hi);
 		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
 
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+		cached = ext4fs_cache_read_extent(block, log2_blksz, blksz);
+		if (cached) {
+			ext_block = (struct ext4_extent_header *)cached;
+			continue;
+		}
+#endif
 		if (ext4fs_devread((lbaint_t)block << log2_blksz, 0, blksz,
 				   buf))
 			ext_block = (struct ext4_extent_header *)buf;
@@ -1575,12 +1973,22 @@ static int ext4fs_blockgroup
 			group / desc_per_blk;
 	blkoff = (group % desc_per_blk) * desc_size;
 
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	if (ext4fs_cache_get_group(group, blkgrp))
+		return 1;
+#endif
 	debug("ext4fs read %d group descriptor (blkno %ld blkoff %u)\n",
 	      group, blkno, blkoff);
 
-	return ext4fs_devread((lbaint_t)blkno <<
-			      (LOG2_BLOCK_SIZE(data) - log2blksz),
-			      blkoff, desc_size, (char *)blkgrp);
+	if (!ext4fs_devread((lbaint_t)blkno <<
+			    (LOG2_BLOCK_SIZE(data) - log2blksz),
+			    blkoff, desc_size, (char *)blkgrp))
+		return 0;
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	ext4fs_cache_add_group(group, blkgrp);
+#endif
+
+	return 1;
 }
 
 int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
@@ -1593,6 +2001,10 @@ int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
 	long int blkno;
 	unsigned int blkoff;
 
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	if (ext4fs_cache_get_inode(ino, inode))
+		return 1;
+#endif
 	/* It is easier to calculate if the first inode is 0. */
 	ino--;
 	status = ext4fs_blockgroup(data, ino / le32_to_cpu
@@ -1610,6 +2022,9 @@ int ext4fs_read_inode(struct ext2_data *data, int ino, struct ext2_inode *inode)
 				sizeof(struct ext2_inode), (char *)inode);
 	if (status == 0)
 		return 0;
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	ext4fs_cache_add_inode(ino + 1, inode);
+#endif
 
 	return 1;
 }
@@ -1631,17 +2046,21 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 
 	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
 		long int startblock, endblock;
-		char *buf = zalloc(blksz);
-		if (!buf)
-			return -ENOMEM;
 		struct ext4_extent_header *ext_block;
 		struct ext4_extent *extent;
+		char *buf = NULL;
 		int i;
-		ext_block =
-			ext4fs_get_extent_block(ext4fs_root, buf,
-						(struct ext4_extent_header *)
-						inode->b.blocks.dir_blocks,
-						fileblock, log2_blksz);
+
+		ext_block = (struct ext4_extent_header *)
+			inode->b.blocks.dir_blocks;
+		/* Extents held in the inode itself need no buffer */
+		if (ext_block->eh_depth) {
+			buf = zalloc(blksz);
+			if (!buf)
+				return -ENOMEM;
+		}
+		ext_block = ext4fs_get_extent_block(ext4fs_root, buf, ext_block,
+						    fileblock, log2_blksz);
 		if (!ext_block) {
 			printf("invalid extent block\n");
 			free(buf);
@@ -1990,7 +2409,8 @@ void ext4fs_reinit_global(void)
 		ext4fs_indir3_blkno = -1;
 	}
 }
-void ext4fs_close(void)
+
+void ext4fs_umount(void)
 {
 	if ((ext4fs_file != NULL) && (ext4fs_root != NULL)) {
 		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
@@ -2002,6 +2422,25 @@ void ext4fs_close(void)
 	}
 
 	ext4fs_reinit_global();
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	ext4fs_cache_flush();
+	ext4fs_mcache.desc = NULL;
+#endif
+}
+
+void ext4fs_close(void)
+{
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	/* Keep the mount for the next command, see ext4fs_probe() */
+	if (ext4fs_root && ext4fs_mcache.desc) {
+		if (ext4fs_file) {
+			ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
+			ext4fs_file = NULL;
+		}
+		return;
+	}
+#endif
+	ext4fs_umount();
 }
 
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
@@ -2330,9 +2769,15 @@ int ext4fs_mount(unsigned part_length)
 	struct ext2_data *data;
 	int status;
 	struct ext_filesystem *fs = get_fs();
+
+	/* Drop any mount still kept from another partition */
+	ext4fs_umount();
 	data = zalloc(SUPERBLOCK_SIZE);
 	if (!data)
 		return 0;
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	ext4fs_cache_reset();
+#endif
 
 	/* Read the superblock. */
 	status = ext4_read_superblock((char *)&data->sblock);
@@ -56,6 +56,26 @@ int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node **fnode, int *ftype);
 
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+/**
+ * ext4fs_session_reuse() - check if the kept mount can be used again
+ *
+ * @desc:	Block device to mount
+ * @part:	Partition to mount
+ * @return true if the filesystem on @part is still mounted and the device
+ * has not changed since it was mounted
+ */
+bool ext4fs_session_reuse(struct blk_desc *desc, disk_partition_t *part);
+
+/**
+ * ext4fs_session_start() - keep the current mount after ext4fs_close()
+ *
+ * @desc:	Block device which was mounted
+ * @part:	Partition which was mounted
+ */
+void ext4fs_session_start(struct blk_desc *desc, disk_partition_t *part);
+#endif
+
 #if defined(CONFIG_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n);
 uint16_t ext4fs_checksum_update(unsigned int i);
@@ -72,6 +92,12 @@ int ext4fs_iget(int inode_no, struct ext2_inode *inode);
 void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 				unsigned int total_remaining_blocks,
 				unsigned int *total_no_of_block);
+int ext4fs_allocate_extents(struct ext2_inode *file_inode,
+			    unsigned int total_remaining_blocks,
+			    unsigned int *total_no_of_block,
+			    struct ext4_extent **extentsp);
+uint32_t ext4fs_blocks_needed(uint32_t data_blocks, bool extents);
+void ext4fs_free_block(long int blknr);
 void put_ext4(uint64_t off, void *buf, uint32_t size);
 struct ext2_block_group *ext4fs_get_group_descriptor
 	(const struct ext_filesystem *fs, uint32_t bg_idx);
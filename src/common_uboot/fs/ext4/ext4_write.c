@@ -74,22 +74,28 @@ static void ext4fs_update(void)
 	put_ext4((uint64_t)(SUPERBLOCK_SIZE),
 		 (struct ext2_sblock *)fs->sb, (uint32_t)SUPERBLOCK_SIZE);
 
-	/* update block bitmaps */
+	/* update the block bitmaps which changed */
 	for (i = 0; i < fs->no_blkgrp; i++) {
 		bgd = ext4fs_get_group_descriptor(fs, i);
 		bgd->bg_checksum = cpu_to_le16(ext4fs_checksum_update(i));
+		if (!fs->blk_bmap_dirty[i])
+			continue;
 		uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
 		put_ext4(b_bitmap_blk * fs->blksz,
 			 fs->blk_bmaps[i], fs->blksz);
 	}
 
-	/* update inode bitmaps */
+	/* update the inode bitmaps which changed */
 	for (i = 0; i < fs->no_blkgrp; i++) {
+		if (!fs->inode_bmap_dirty[i])
+			continue;
 		bgd = ext4fs_get_group_descriptor(fs, i);
 		uint64_t i_bitmap_blk = ext4fs_bg_get_inode_id(bgd, fs);
 		put_ext4(i_bitmap_blk * fs->blksz,
 			 fs->inode_bmaps[i], fs->blksz);
 	}
+	memset(fs->blk_bmap_dirty, '\0', fs->no_blkgrp);
+	memset(fs->inode_bmap_dirty, '\0', fs->no_blkgrp);
 
 	/* update the block group descriptor table */
 	put_ext4((uint64_t)((uint64_t)fs->gdtable_blkno * (uint64_t)fs->blksz),
@@ -132,72 +138,49 @@ fail:
 	return -1;
 }
 
-static void delete_single_indirect_block(struct ext2_inode *inode)
+/*
+ * Release a block in the block bitmap, the group descriptor and the
+ * superblock. The bitmap is saved for the journal the first time it changes.
+ */
+void ext4fs_free_block(long int blknr)
 {
-	struct ext2_block_group *bgd = NULL;
-	static int prev_bg_bmap_idx = -1;
-	uint32_t blknr;
-	int remainder;
 	int bg_idx;
-	int status;
 	uint32_t blk_per_grp = le32_to_cpu(ext4fs_root->sblock.blocks_per_group);
+	struct ext2_block_group *bgd = NULL;
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	if (!journal_buffer) {
-		printf("No memory\n");
-		return;
+
+	bg_idx = blknr / blk_per_grp;
+	if (fs->blksz == 1024) {
+		if (!(blknr % blk_per_grp))
+			bg_idx--;
 	}
+	ext4fs_reset_block_bmap(blknr, fs->blk_bmaps[bg_idx], bg_idx);
+	/* get  block group descriptor table */
+	bgd = ext4fs_get_group_descriptor(fs, bg_idx);
+	ext4fs_bg_free_blocks_inc(bgd, fs);
+	ext4fs_sb_free_blocks_inc(fs->sb);
+}
+
+static void delete_single_indirect_block(struct ext2_inode *inode)
+{
+	uint32_t blknr;
 
 	/* deleting the single indirect block associated with inode */
 	if (inode->b.blocks.indir_block != 0) {
 		blknr = le32_to_cpu(inode->b.blocks.indir_block);
 		debug("SIPB releasing %u\n", blknr);
-		bg_idx = blknr / blk_per_grp;
-		if (fs->blksz == 1024) {
-			remainder = blknr % blk_per_grp;
-			if (!remainder)
-				bg_idx--;
-		}
-		ext4fs_reset_block_bmap(blknr, fs->blk_bmaps[bg_idx], bg_idx);
-		/* get  block group descriptor table */
-		bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-		ext4fs_bg_free_blocks_inc(bgd, fs);
-		ext4fs_sb_free_blocks_inc(fs->sb);
-		/* journal backup */
-		if (prev_bg_bmap_idx != bg_idx) {
-			uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
-			status = ext4fs_devread(
-					   b_bitmap_blk * fs->sect_perblk,
-					   0, fs->blksz, journal_buffer);
-			if (status == 0)
-				goto fail;
-			if (ext4fs_log_journal(journal_buffer, b_bitmap_blk))
-				goto fail;
-			prev_bg_bmap_idx = bg_idx;
-		}
+		ext4fs_free_block(blknr);
 	}
-fail:
-	free(journal_buffer);
 }
 
 static void delete_double_indirect_block(struct ext2_inode *inode)
 {
 	int i;
 	short status;
-	static int prev_bg_bmap_idx = -1;
 	uint32_t blknr;
-	int remainder;
-	int bg_idx;
-	uint32_t blk_per_grp = le32_to_cpu(ext4fs_root->sblock.blocks_per_group);
 	__le32 *di_buffer = NULL;
 	void *dib_start_addr = NULL;
-	struct ext2_block_group *bgd = NULL;
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	if (!journal_buffer) {
-		printf("No memory\n");
-		return;
-	}
 
 	if (inode->b.blocks.double_indir_block != 0) {
 		di_buffer = zalloc(fs->blksz);
@@ -209,94 +192,35 @@ static void delete_double_indirect_block(struct ext2_inode *inode)
 		blknr = le32_to_cpu(inode->b.blocks.double_indir_block);
 		status = ext4fs_devread((lbaint_t)blknr * fs->sect_perblk, 0,
 					fs->blksz, (char *)di_buffer);
+		if (status == 0)
+			goto fail;
 		for (i = 0; i < fs->blksz / sizeof(int); i++) {
 			if (*di_buffer == 0)
 				break;
 
 			debug("DICB releasing %u\n", *di_buffer);
-			bg_idx = le32_to_cpu(*di_buffer) / blk_per_grp;
-			if (fs->blksz == 1024) {
-				remainder = le32_to_cpu(*di_buffer) % blk_per_grp;
-				if (!remainder)
-					bg_idx--;
-			}
-			/* get  block group descriptor table */
-			bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-			ext4fs_reset_block_bmap(le32_to_cpu(*di_buffer),
-					fs->blk_bmaps[bg_idx], bg_idx);
+			ext4fs_free_block(le32_to_cpu(*di_buffer));
 			di_buffer++;
-			ext4fs_bg_free_blocks_inc(bgd, fs);
-			ext4fs_sb_free_blocks_inc(fs->sb);
-			/* journal backup */
-			if (prev_bg_bmap_idx != bg_idx) {
-				uint64_t b_bitmap_blk =
-					ext4fs_bg_get_block_id(bgd, fs);
-				status = ext4fs_devread(b_bitmap_blk
-							* fs->sect_perblk, 0,
-							fs->blksz,
-							journal_buffer);
-				if (status == 0)
-					goto fail;
-
-				if (ext4fs_log_journal(journal_buffer,
-						       b_bitmap_blk))
-					goto fail;
-				prev_bg_bmap_idx = bg_idx;
-			}
 		}
 
 		/* removing the parent double indirect block */
-		blknr = le32_to_cpu(inode->b.blocks.double_indir_block);
-		bg_idx = blknr / blk_per_grp;
-		if (fs->blksz == 1024) {
-			remainder = blknr % blk_per_grp;
-			if (!remainder)
-				bg_idx--;
-		}
-		/* get  block group descriptor table */
-		bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-		ext4fs_reset_block_bmap(blknr, fs->blk_bmaps[bg_idx], bg_idx);
-		ext4fs_bg_free_blocks_inc(bgd, fs);
-		ext4fs_sb_free_blocks_inc(fs->sb);
-		/* journal backup */
-		if (prev_bg_bmap_idx != bg_idx) {
-			uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
-			status = ext4fs_devread(b_bitmap_blk * fs->sect_perblk,
-						0, fs->blksz, journal_buffer);
-			if (status == 0)
-				goto fail;
-
-			if (ext4fs_log_journal(journal_buffer, b_bitmap_blk))
-				goto fail;
-			prev_bg_bmap_idx = bg_idx;
-		}
+		ext4fs_free_block(blknr);
 		debug("DIPB releasing %d\n", blknr);
 	}
 fail:
 	free(dib_start_addr);
-	free(journal_buffer);
 }
 
 static void delete_triple_indirect_block(struct ext2_inode *inode)
 {
 	int i, j;
 	short status;
-	static int prev_bg_bmap_idx = -1;
 	uint32_t blknr;
-	int remainder;
-	int bg_idx;
-	uint32_t blk_per_grp = le32_to_cpu(ext4fs_root->sblock.blocks_per_group);
 	__le32 *tigp_buffer = NULL;
 	void *tib_start_addr = NULL;
 	__le32 *tip_buffer = NULL;
 	void *tipb_start_addr = NULL;
-	struct ext2_block_group *bgd = NULL;
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	if (!journal_buffer) {
-		printf("No memory\n");
-		return;
-	}
 
 	if (inode->b.blocks.triple_indir_block != 0) {
 		tigp_buffer = zalloc(fs->blksz);
@@ -308,127 +232,110 @@ static void delete_triple_indirect_block(struct ext2_inode *inode)
 		blknr = le32_to_cpu(inode->b.blocks.triple_indir_block);
 		status = ext4fs_devread((lbaint_t)blknr * fs->sect_perblk, 0,
 					fs->blksz, (char *)tigp_buffer);
+		if (status == 0)
+			goto fail;
+		tip_buffer = zalloc(fs->blksz);
+		if (!tip_buffer)
+			goto fail;
+		tipb_start_addr = tip_buffer;
 		for (i = 0; i < fs->blksz / sizeof(int); i++) {
 			if (*tigp_buffer == 0)
 				break;
 			debug("tigp buffer releasing %u\n", *tigp_buffer);
 
-			tip_buffer = zalloc(fs->blksz);
-			if (!tip_buffer)
-				goto fail;
-			tipb_start_addr = tip_buffer;
+			tip_buffer = tipb_start_addr;
 			status = ext4fs_devread((lbaint_t)le32_to_cpu(*tigp_buffer) *
 						fs->sect_perblk, 0, fs->blksz,
 						(char *)tip_buffer);
+			if (status == 0)
+				goto fail;
 			for (j = 0; j < fs->blksz / sizeof(int); j++) {
 				if (le32_to_cpu(*tip_buffer) == 0)
 					break;
-				bg_idx = le32_to_cpu(*tip_buffer) / blk_per_grp;
-				if (fs->blksz == 1024) {
-					remainder = le32_to_cpu(*tip_buffer) % blk_per_grp;
-					if (!remainder)
-						bg_idx--;
-				}
-
-				ext4fs_reset_block_bmap(le32_to_cpu(*tip_buffer),
-							fs->blk_bmaps[bg_idx],
-							bg_idx);
-
+				ext4fs_free_block(le32_to_cpu(*tip_buffer));
 				tip_buffer++;
-				/* get  block group descriptor table */
-				bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-				ext4fs_bg_free_blocks_inc(bgd, fs);
-				ext4fs_sb_free_blocks_inc(fs->sb);
-				/* journal backup */
-				if (prev_bg_bmap_idx != bg_idx) {
-					uint64_t b_bitmap_blk =
-						ext4fs_bg_get_block_id(bgd, fs);
-					status =
-					    ext4fs_devread(
-							b_bitmap_blk *
-							fs->sect_perblk, 0,
-							fs->blksz,
-							journal_buffer);
-					if (status == 0)
-						goto fail;
-
-					if (ext4fs_log_journal(journal_buffer,
-							       b_bitmap_blk))
-						goto fail;
-					prev_bg_bmap_idx = bg_idx;
-				}
 			}
-			free(tipb_start_addr);
-			tipb_start_addr = NULL;
 
 			/*
 			 * removing the grand parent blocks
 			 * which is connected to inode
 			 */
-			bg_idx = le32_to_cpu(*tigp_buffer) / blk_per_grp;
-			if (fs->blksz == 1024) {
-				remainder = le32_to_cpu(*tigp_buffer) % blk_per_grp;
-				if (!remainder)
-					bg_idx--;
-			}
-			ext4fs_reset_block_bmap(le32_to_cpu(*tigp_buffer),
-						fs->blk_bmaps[bg_idx], bg_idx);
-
+			ext4fs_free_block(le32_to_cpu(*tigp_buffer));
 			tigp_buffer++;
-			/* get  block group descriptor table */
-			bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-			ext4fs_bg_free_blocks_inc(bgd, fs);
-			ext4fs_sb_free_blocks_inc(fs->sb);
-			/* journal backup */
-			if (prev_bg_bmap_idx != bg_idx) {
-				uint64_t b_bitmap_blk =
-					ext4fs_bg_get_block_id(bgd, fs);
-				memset(journal_buffer, '\0', fs->blksz);
-				status = ext4fs_devread(b_bitmap_blk *
-							fs->sect_perblk, 0,
-							fs->blksz,
-							journal_buffer);
-				if (status == 0)
-					goto fail;
-
-				if (ext4fs_log_journal(journal_buffer,
-						       b_bitmap_blk))
-					goto fail;
-				prev_bg_bmap_idx = bg_idx;
-			}
 		}
 
 		/* removing the grand parent triple indirect block */
-		blknr = le32_to_cpu(inode->b.blocks.triple_indir_block);
-		bg_idx = blknr / blk_per_grp;
-		if (fs->blksz == 1024) {
-			remainder = blknr % blk_per_grp;
-			if (!remainder)
-				bg_idx--;
-		}
-		ext4fs_reset_block_bmap(blknr, fs->blk_bmaps[bg_idx], bg_idx);
-		/* get  block group descriptor table */
-		bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-		ext4fs_bg_free_blocks_inc(bgd, fs);
-		ext4fs_sb_free_blocks_inc(fs->sb);
-		/* journal backup */
-		if (prev_bg_bmap_idx != bg_idx) {
-			uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
-			status = ext4fs_devread(b_bitmap_blk * fs->sect_perblk,
-						0, fs->blksz, journal_buffer);
-			if (status == 0)
-				goto fail;
-
-			if (ext4fs_log_journal(journal_buffer, b_bitmap_blk))
-				goto fail;
-			prev_bg_bmap_idx = bg_idx;
-		}
+		ext4fs_free_block(blknr);
 		debug("tigp buffer itself releasing %d\n", blknr);
 	}
 fail:
 	free(tib_start_addr);
 	free(tipb_start_addr);
-	free(journal_buffer);
+}
+
+/**
+ * delete_extent_tree() - release the blocks of an extent tree
+ *
+ * Releases the blocks covered by each extent and, below the inode, the index
+ * and leaf blocks of the tree.
+ *
+ * @eh:		Header of the node to release
+ * @depth:	Expected depth of the node
+ * @return 0 if OK, -ve on error
+ */
+static int delete_extent_tree(struct ext4_extent_header *eh, int depth)
+{
+	struct ext_filesystem *fs = get_fs();
+	int entries = le16_to_cpu(eh->eh_entries);
+	struct ext4_extent_idx *index;
+	struct ext4_extent *ext;
+	uint64_t blknr;
+	char *buf;
+	int i, j, len, ret = 0;
+
+	if (le16_to_cpu(eh->eh_magic) != EXT4_EXT_MAGIC ||
+	    le16_to_cpu(eh->eh_depth) != depth)
+		return -EINVAL;
+
+	if (!depth) {
+		ext = (struct ext4_extent *)(eh + 1);
+		for (i = 0; i < entries; i++, ext++) {
+			blknr = ((uint64_t)le16_to_cpu(ext->ee_start_hi) << 32) +
+				le32_to_cpu(ext->ee_start_lo);
+			len = le16_to_cpu(ext->ee_len);
+			/* uninitialised extents are stored with a bias */
+			if (len > EXT4_EXT_INIT_MAX_LEN)
+				len -= EXT4_EXT_INIT_MAX_LEN;
+			debug("EXT4 extent releasing %llu: %d\n",
+			      (unsigned long long)blknr, len);
+			for (j = 0; j < len; j++)
+				ext4fs_free_block(blknr + j);
+		}
+
+		return 0;
+	}
+
+	buf = zalloc(fs->blksz);
+	if (!buf)
+		return -ENOMEM;
+	index = (struct ext4_extent_idx *)(eh + 1);
+	for (i = 0; i < entries; i++, index++) {
+		blknr = ((uint64_t)le16_to_cpu(index->ei_leaf_hi) << 32) +
+			le32_to_cpu(index->ei_leaf_lo);
+		if (!ext4fs_devread((lbaint_t)blknr * fs->sect_perblk, 0,
+				    fs->blksz, buf)) {
+			ret = -EIO;
+			break;
+		}
+		ret = delete_extent_tree((struct ext4_extent_header *)buf,
+					 depth - 1);
+		if (ret)
+			break;
+		ext4fs_free_block(blknr);
+	}
+	free(buf);
+
+	return ret;
 }
 
 static int ext4fs_delete_file(int inodeno)
@@ -436,26 +343,19 @@ static int ext4fs_delete_file(int inodeno)
 	struct ext2_inode inode;
 	short status;
 	int i;
-	int remainder;
 	long int blknr;
-	int bg_idx;
 	int ibmap_idx;
 	char *read_buffer = NULL;
 	char *start_block_address = NULL;
 	uint32_t no_blocks;
 
-	static int prev_bg_bmap_idx = -1;
 	unsigned int inodes_per_block;
 	uint32_t blkno;
 	unsigned int blkoff;
-	uint32_t blk_per_grp = le32_to_cpu(ext4fs_root->sblock.blocks_per_group);
 	uint32_t inode_per_grp = le32_to_cpu(ext4fs_root->sblock.inodes_per_group);
 	struct ext2_inode *inode_buffer = NULL;
 	struct ext2_block_group *bgd = NULL;
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	if (!journal_buffer)
-		return -ENOMEM;
 	status = ext4fs_read_inode(ext4fs_root, inodeno, &inode);
 	if (status == 0)
 		goto fail;
@@ -466,11 +366,14 @@ static int ext4fs_delete_file(int inodeno)
 		no_blocks++;
 
 	if (le32_to_cpu(inode.flags) & EXT4_EXTENTS_FL) {
-		/* FIXME delete extent index blocks, i.e. eh_depth >= 1 */
 		struct ext4_extent_header *eh =
 			(struct ext4_extent_header *)
 				inode.b.blocks.dir_blocks;
 		debug("del: dep=%d entries=%d\n", eh->eh_depth, eh->eh_entries);
+		/* data blocks are released along with the tree */
+		if (delete_extent_tree(eh, le16_to_cpu(eh->eh_depth)))
+			goto fail;
+		no_blocks = 0;
 	} else {
 		delete_single_indirect_block(&inode);
 		delete_double_indirect_block(&inode);
@@ -484,32 +387,8 @@ static int ext4fs_delete_file(int inodeno)
 			continue;
 		if (blknr < 0)
 			goto fail;
-		bg_idx = blknr / blk_per_grp;
-		if (fs->blksz == 1024) {
-			remainder = blknr % blk_per_grp;
-			if (!remainder)
-				bg_idx--;
-		}
-		ext4fs_reset_block_bmap(blknr, fs->blk_bmaps[bg_idx],
-					bg_idx);
-		debug("EXT4 Block releasing %ld: %d\n", blknr, bg_idx);
-
-		/* get  block group descriptor table */
-		bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-		ext4fs_bg_free_blocks_inc(bgd, fs);
-		ext4fs_sb_free_blocks_inc(fs->sb);
-		/* journal backup */
-		if (prev_bg_bmap_idx != bg_idx) {
-			uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
-			status = ext4fs_devread(b_bitmap_blk * fs->sect_perblk,
-						0, fs->blksz,
-						journal_buffer);
-			if (status == 0)
-				goto fail;
-			if (ext4fs_log_journal(journal_buffer, b_bitmap_blk))
-				goto fail;
-			prev_bg_bmap_idx = bg_idx;
-		}
+		debug("EXT4 Block releasing %ld\n", blknr);
+		ext4fs_free_block(blknr);
 	}
 
 	/* release inode */
@@ -553,14 +432,6 @@ static int ext4fs_delete_file(int inodeno)
 	ext4fs_reset_inode_bmap(inodeno, fs->inode_bmaps[ibmap_idx], ibmap_idx);
 	ext4fs_bg_free_inodes_inc(bgd, fs);
 	ext4fs_sb_free_inodes_inc(fs->sb);
-	/* journal backup */
-	memset(journal_buffer, '\0', fs->blksz);
-	status = ext4fs_devread(ext4fs_bg_get_inode_id(bgd, fs) *
-				fs->sect_perblk, 0, fs->blksz, journal_buffer);
-	if (status == 0)
-		goto fail;
-	if (ext4fs_log_journal(journal_buffer, ext4fs_bg_get_inode_id(bgd, fs)))
-		goto fail;
 
 	ext4fs_update();
 	ext4fs_deinit();
@@ -572,12 +443,10 @@ static int ext4fs_delete_file(int inodeno)
 	}
 
 	free(start_block_address);
-	free(journal_buffer);
 
 	return 0;
 fail:
 	free(start_block_address);
-	free(journal_buffer);
 
 	return -1;
 }
@@ -619,7 +488,8 @@ int ext4fs_init(void)
 
 	/* load all the available bitmap block of the partition */
 	fs->blk_bmaps = zalloc(fs->no_blkgrp * sizeof(char *));
-	if (!fs->blk_bmaps)
+	fs->blk_bmap_dirty = zalloc(fs->no_blkgrp);
+	if (!fs->blk_bmaps || !fs->blk_bmap_dirty)
 		goto fail;
 	for (i = 0; i < fs->no_blkgrp; i++) {
 		fs->blk_bmaps[i] = zalloc(fs->blksz);
@@ -639,7 +509,8 @@ int ext4fs_init(void)
 
 	/* load all the available inode bitmap of the partition */
 	fs->inode_bmaps = zalloc(fs->no_blkgrp * sizeof(unsigned char *));
-	if (!fs->inode_bmaps)
+	fs->inode_bmap_dirty = zalloc(fs->no_blkgrp);
+	if (!fs->inode_bmaps || !fs->inode_bmap_dirty)
 		goto fail;
 	for (i = 0; i < fs->no_blkgrp; i++) {
 		fs->inode_bmaps[i] = zalloc(fs->blksz);
@@ -733,7 +604,10 @@ void ext4fs_deinit(void)
 		free(fs->inode_bmaps);
 		fs->inode_bmaps = NULL;
 	}
-
+	free(fs->blk_bmap_dirty);
+	fs->blk_bmap_dirty = NULL;
+	free(fs->inode_bmap_dirty);
+	fs->inode_bmap_dirty = NULL;
 
 	free(fs->gdtable);
 	fs->gdtable = NULL;
@@ -830,6 +704,41 @@ static int ext4fs_write_file(struct ext2_inode *file_inode,
 	return len;
 }
 
+/*
+ * Write data to the extents allocated by ext4fs_allocate_extents(). Each
+ * extent is written in one go; only a partial last block goes through a
+ * bounce buffer, so nothing past the end of @buf is written to disk.
+ */
+static int ext4fs_write_extents(const struct ext4_extent *ext, int count,
+				char *buf, unsigned int len)
+{
+	struct ext_filesystem *fs = get_fs();
+	uint64_t start;
+	uint32_t pos, size, whole;
+	char *tail;
+	int i;
+
+	for (i = 0; i < count; i++, ext++) {
+		start = ((uint64_t)le16_to_cpu(ext->ee_start_hi) << 32) +
+			le32_to_cpu(ext->ee_start_lo);
+		pos = le32_to_cpu(ext->ee_block) * fs->blksz;
+		size = min(le16_to_cpu(ext->ee_len) * fs->blksz, len - pos);
+		whole = size & ~(fs->blksz - 1);
+		if (whole)
+			put_ext4(start * fs->blksz, buf + pos, whole);
+		if (whole == size)
+			continue;
+		tail = zalloc(fs->blksz);
+		if (!tail)
+			return -ENOMEM;
+		memcpy(tail, buf + pos + whole, size - whole);
+		put_ext4((start * fs->blksz) + whole, tail, fs->blksz);
+		free(tail);
+	}
+
+	return 0;
+}
+
 int ext4fs_write(const char *fname, unsigned char *buffer,
 					unsigned long sizebytes)
 {
@@ -844,6 +753,8 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 	unsigned int blks_reqd_for_file;
 	unsigned int blocks_remaining;
 	int existing_file_inodeno;
+	uint32_t blocks_free;
+	bool use_extents;
 	char *temp_ptr = NULL;
 	long int itable_blkno;
 	long int parent_itable_blkno;
@@ -853,6 +764,8 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 	unsigned int ibmap_idx;
 	struct ext2_block_group *bgd = NULL;
 	struct ext_filesystem *fs = get_fs();
+	struct ext4_extent *extents = NULL;
+	int extent_count = -1;
 	ALLOC_CACHE_ALIGN_BUFFER(char, filename, 256);
 	memset(filename, 0x00, 256);
 
@@ -875,8 +788,38 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 		printf("hash tree directory\n");
 		goto fail;
 	}
+	/* calucalate how many blocks required */
+	bytes_reqd_for_file = sizebytes;
+	blks_reqd_for_file = lldiv(bytes_reqd_for_file, fs->blksz);
+	if (do_div(bytes_reqd_for_file, fs->blksz) != 0) {
+		blks_reqd_for_file++;
+		debug("total bytes for a file %u\n", blks_reqd_for_file);
+	}
+	blocks_remaining = blks_reqd_for_file;
+	use_extents = le32_to_cpu(fs->sb->feature_incompat) &
+		EXT4_FEATURE_INCOMPAT_EXTENTS;
+	blocks_free = le32_to_cpu(fs->sb->free_blocks);
+
 	/* check if the filename is already present in root */
 	existing_file_inodeno = ext4fs_filename_unlink(filename);
+	if (existing_file_inodeno != -1) {
+		struct ext2_inode old_inode;
+
+		if (!ext4fs_read_inode(ext4fs_root, existing_file_inodeno,
+				       &old_inode))
+			goto fail;
+		blocks_free += le32_to_cpu(old_inode.blockcnt) >>
+			(LOG2_BLOCK_SIZE(ext4fs_root) - 9);
+	}
+	/*
+	 * Test for available space in partition. Nothing has been written
+	 * yet, so the old file is still intact if there is not enough.
+	 */
+	if (blocks_free < ext4fs_blocks_needed(blks_reqd_for_file,
+					       use_extents)) {
+		printf("Not enough space on partition !!!\n");
+		goto fail;
+	}
 	if (existing_file_inodeno != -1) {
 		ret = ext4fs_delete_file(existing_file_inodeno);
 		fs->first_pass_bbmap = 0;
@@ -887,19 +830,6 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 		if (ret)
 			goto fail;
 	}
-	/* calucalate how many blocks required */
-	bytes_reqd_for_file = sizebytes;
-	blks_reqd_for_file = lldiv(bytes_reqd_for_file, fs->blksz);
-	if (do_div(bytes_reqd_for_file, fs->blksz) != 0) {
-		blks_reqd_for_file++;
-		debug("total bytes for a file %u\n", blks_reqd_for_file);
-	}
-	blocks_remaining = blks_reqd_for_file;
-	/* test for available space in partition */
-	if (le32_to_cpu(fs->sb->free_blocks) < blks_reqd_for_file) {
-		printf("Not enough space on partition !!!\n");
-		goto fail;
-	}
 
 	inodeno = ext4fs_update_parent_dentry(filename, FILETYPE_REG);
 	if (inodeno == -1)
@@ -919,8 +849,17 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 	file_inode->size = cpu_to_le32(sizebytes);
 
 	/* Allocate data blocks */
-	ext4fs_allocate_blocks(file_inode, blocks_remaining,
-			       &blks_reqd_for_file);
+	if (use_extents) {
+		extent_count = ext4fs_allocate_extents(file_inode,
+						       blocks_remaining,
+						       &blks_reqd_for_file,
+						       &extents);
+		if (extent_count < 0)
+			goto fail;
+	} else {
+		ext4fs_allocate_blocks(file_inode, blocks_remaining,
+				       &blks_reqd_for_file);
+	}
 	file_inode->blockcnt = cpu_to_le32((blks_reqd_for_file * fs->blksz) >>
 		fs->dev_desc->log2blksz);
 
@@ -943,9 +882,18 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 	if (ext4fs_put_metadata(temp_ptr, itable_blkno))
 		goto fail;
 	/* copy the file content into data blocks */
-	if (ext4fs_write_file(file_inode, 0, sizebytes, (char *)buffer) == -1) {
+	if (extent_count >= 0)
+		ret = ext4fs_write_extents(extents, extent_count,
+					   (char *)buffer, sizebytes);
+	else
+		ret = ext4fs_write_file(file_inode, 0, sizebytes,
+					(char *)buffer);
+	if (ret < 0) {
+		/*
+		 * The bitmaps with this file's blocks have not been written
+		 * back, so dropping them below deallocates the blocks
+		 */
 		printf("Error in copying content\n");
-		/* FIXME: Deallocate data blocks */
 		goto fail;
 	}
 	ibmap_idx = parent_inodeno / le32_to_cpu(ext4fs_root->sblock.inodes_per_group);
@@ -985,11 +933,13 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 	free(inode_buffer);
 	free(g_parent_inode);
 	free(temp_ptr);
+	free(extents);
 	g_parent_inode = NULL;
 
 	return 0;
 fail:
 	ext4fs_deinit();
+	free(extents);
 	free(inode_buffer);
 	free(g_parent_inode);
 	free(temp_ptr);
@@ -210,12 +210,22 @@ int ext4fs_read(char *buf, loff_t offset, loff_t len, loff_t *actread)
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 disk_partition_t *fs_partition)
 {
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	/* Use the filesystem kept mounted by the previous command */
+	if (ext4fs_session_reuse(fs_dev_desc, fs_partition)) {
+		ext4fs_set_blk_dev(fs_dev_desc, fs_partition);
+		return 0;
+	}
+#endif
 	ext4fs_set_blk_dev(fs_dev_desc, fs_partition);
 
 	if (!ext4fs_mount(fs_partition->size)) {
-		ext4fs_close();
+		ext4fs_umount();
 		return -1;
 	}
+#ifdef CONFIG_EXT4_MOUNT_SESSION
+	ext4fs_session_start(fs_dev_desc, fs_partition);
+#endif
 
 	return 0;
 }
@@ -278,14 +278,136 @@ const char *fs_get_type_name(void)
 	return fs_get_info(fs_type)->name;
 }
 
-int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
+/*
+ * Finding the filesystem on a partition means probing each filesystem in
+ * turn, each reading its superblock or boot sector, and scripts do this for
+ * every file they load. So remember what was found on the last few
+ * partitions, and only probe that filesystem next time. Entries are
+ * dropped when the device is written or the media changes, which the block
+ * layer tracks in blk_desc->change_gen.
+ */
+#define FS_TYPE_CACHE_SIZE	8
+
+/**
+ * struct fs_type_cache - filesystem found on a partition
+ *
+ * @desc:	Block device, or NULL if the entry is unused
+ * @hwpart:	Hardware partition selected on @desc
+ * @part:	Partition number (0 for the whole device)
+ * @start:	Start block of the partition
+ * @change_gen:	Value of @desc->change_gen when the partition was probed
+ * @fstype:	Filesystem found (FS_TYPE_...), or FS_TYPE_ANY if none
+ */
+struct fs_type_cache {
+	struct blk_desc *desc;
+	int hwpart;
+	int part;
+	lbaint_t start;
+	unsigned int change_gen;
+	int fstype;
+};
+
+static struct fs_type_cache fs_type_cache[FS_TYPE_CACHE_SIZE];
+static int fs_type_cache_next;
+
+static struct fs_type_cache *fs_type_cache_find(int part)
+{
+	struct fs_type_cache *ent;
+
+	if (!fs_dev_desc)
+		return NULL;
+	for (ent = fs_type_cache; ent < fs_type_cache + FS_TYPE_CACHE_SIZE;
+	     ent++) {
+		if (ent->desc == fs_dev_desc &&
+		    ent->hwpart == fs_dev_desc->hwpart && ent->part == part &&
+		    ent->start == fs_partition.start) {
+			if (ent->change_gen == fs_dev_desc->change_gen)
+				return ent;
+			ent->desc = NULL;
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static void fs_type_cache_add(int part, int fstype)
+{
+	struct fs_type_cache *ent;
+
+	if (!fs_dev_desc)
+		return;
+	ent = fs_type_cache_find(part);
+	if (!ent) {
+		ent = &fs_type_cache[fs_type_cache_next];
+		fs_type_cache_next = (fs_type_cache_next + 1) %
+			FS_TYPE_CACHE_SIZE;
+	}
+	ent->desc = fs_dev_desc;
+	ent->hwpart = fs_dev_desc->hwpart;
+	ent->part = part;
+	ent->start = fs_partition.start;
+	ent->change_gen = fs_dev_desc->change_gen;
+	ent->fstype = fstype;
+}
+
+/**
+ * fs_probe() - find the filesystem on the current partition
+ *
+ * @fstype:	Filesystem to look for (FS_TYPE_...), or FS_TYPE_ANY for any
+ * @part:	Partition number
+ * @return 0 if found, -1 if not
+ */
+static int fs_probe(int fstype, int part)
 {
+	struct fs_type_cache *ent = fs_type_cache_find(part);
 	struct fstype_info *info;
-	int part, i;
+	int i;
+
+	if (ent && (fstype == FS_TYPE_ANY || fstype == ent->fstype)) {
+		/* For FS_TYPE_ANY this reports that there is no filesystem */
+		info = fs_get_info(ent->fstype);
+		if (!info->probe(fs_dev_desc, &fs_partition)) {
+			fs_type = info->fstype;
+			fs_dev_part = part;
+			return 0;
+		}
+		if (ent->fstype == FS_TYPE_ANY)
+			return -1;
+		ent->desc = NULL;
+	}
+
+	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
+		if (fstype != FS_TYPE_ANY && info->fstype != FS_TYPE_ANY &&
+				fstype != info->fstype)
+			continue;
+
+		if (!fs_dev_desc && !info->null_dev_desc_ok)
+			continue;
+
+		if (!info->probe(fs_dev_desc, &fs_partition)) {
+			fs_type = info->fstype;
+			fs_dev_part = part;
+			fs_type_cache_add(part, fs_type);
+			return 0;
+		}
+	}
+	if (fstype == FS_TYPE_ANY)
+		fs_type_cache_add(part, FS_TYPE_ANY);
+
+	return -1;
+}
+
+int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
+{
+	int part;
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
 	static int relocated;
 
 	if (!relocated) {
+		struct fstype_info *info;
+		int i;
+
 		for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes);
 				i++, info++) {
 			info->name += gd->reloc_off;
@@ -304,29 +426,13 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 	if (part < 0)
 		return -1;
 
-	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
-		if (fstype != FS_TYPE_ANY && info->fstype != FS_TYPE_ANY &&
-				fstype != info->fstype)
-			continue;
-
-		if (!fs_dev_desc && !info->null_dev_desc_ok)
-			continue;
-
-		if (!info->probe(fs_dev_desc, &fs_partition)) {
-			fs_type = info->fstype;
-			fs_dev_part = part;
-			return 0;
-		}
-	}
-
-	return -1;
+	return fs_probe(fstype, part);
 }
 
 /* set current blk device w/ blk_desc + partition # */
 int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 {
-	struct fstype_info *info;
-	int ret, i;
+	int ret;
 
 	if (part >= 1)
 		ret = part_get_info(desc, part, &fs_partition);
@@ -336,14 +442,7 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 		return ret;
 	fs_dev_desc = desc;
 
-	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
-		if (!info->probe(fs_dev_desc, &fs_partition)) {
-			fs_type = info->fstype;
-			return 0;
-		}
-	}
-
-	return -1;
+	return fs_probe(FS_TYPE_ANY, part);
 }
 
 static void fs_close(void)
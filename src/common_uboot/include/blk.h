@@ -84,6 +84,15 @@ struct blk_desc {
 		uint32_t mbr_sig;	/* MBR integer signature */
 		efi_guid_t guid_sig;	/* GPT GUID Signature */
 	};
+	/*
+	 * Changed whenever the contents of the device may have changed,
+	 * i.e. on a write, an erase or a media change (see part_init()), so
+	 * that anything cached about the contents can be checked. See
+	 * blk_mark_changed().
+	 */
+	unsigned int	change_gen;
+	/* Value of change_gen when part_type was last found */
+	unsigned int	part_type_gen;
 #if CONFIG_IS_ENABLED(BLK)
 	/*
 	 * For now we have a few functions which take struct blk_desc as a
@@ -107,6 +116,23 @@ struct blk_desc {
 #endif
 };
 
+/* Last value given to blk_desc->change_gen */
+extern unsigned int blk_change_gen;
+
+/**
+ * blk_mark_changed() - record that the contents of a device may have changed
+ *
+ * This gives the device a change generation which no device has had before,
+ * so nothing cached about the old contents can match again, even if @desc is
+ * freed and later reused for another device.
+ *
+ * @desc:	Block device which changed
+ */
+static inline void blk_mark_changed(struct blk_desc *desc)
+{
+	desc->change_gen = ++blk_change_gen;
+}
+
 #define BLOCK_CNT(size, blk_desc) (PAD_COUNT(size, blk_desc->blksz))
 #define PAD_TO_BLOCKSIZE(size, blk_desc) \
 	(PAD_SIZE(size, blk_desc->blksz))
@@ -439,6 +465,7 @@ static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blk_mark_changed(block_dev);
 	return block_dev->block_write(block_dev, start, blkcnt, buffer);
 }
 
@@ -446,6 +473,7 @@ static inline ulong blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt)
 {
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
+	blk_mark_changed(block_dev);
 	return block_dev->block_erase(block_dev, start, blkcnt);
 }
 
@@ -199,6 +199,8 @@ enum bootstage_id {
 	BOOTSTATE_ID_ACCUM_DM_SPL,
 	BOOTSTATE_ID_ACCUM_DM_F,
 	BOOTSTATE_ID_ACCUM_DM_R,
+	BOOTSTAGE_ID_ACCUM_HUSH_PARSE,
+	BOOTSTAGE_ID_RELOCATE,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
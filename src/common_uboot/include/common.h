@@ -376,6 +376,11 @@ void	reset_timer	   (void);
 /* Return value of monotonic microsecond timer */
 unsigned long timer_get_us(void);
 
+#ifdef CONFIG_SYS_TIMER_COUNTER
+/* Return raw value of the system timer (lib/time.c) */
+unsigned long timer_read_counter(void);
+#endif
+
 void	enable_interrupts  (void);
 int	disable_interrupts (void);
 
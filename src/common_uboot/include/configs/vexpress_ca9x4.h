@@ -13,4 +13,18 @@
 #define CONFIG_VEXPRESS_ORIGINAL_MEMORY_MAP
 #include "vexpress_common.h"
 
+/*
+ * SPL / Falcon mode: SPL runs from DRAM just below U-Boot's link address
+ * and loads the payload straight into the start of RAM.
+ */
+#define CONFIG_SPL_TEXT_BASE		0x60700000
+#define CONFIG_SPL_MAX_SIZE		0x00040000
+#define CONFIG_SPL_STACK		0x607f0000
+#define CONFIG_SYS_SPL_MALLOC_START	0x60600000
+#define CONFIG_SYS_SPL_MALLOC_SIZE	0x00100000
+
+#define CONFIG_SYS_MMCSD_FS_BOOT_PARTITION	1
+#define CONFIG_SPL_FS_LOAD_PAYLOAD_NAME		"u-boot.img"
+#define CONFIG_SPL_FS_LOAD_KERNEL_NAME		"bare-arm.uimg"
+
 #endif /* VEXPRESS_CA9X4_H */
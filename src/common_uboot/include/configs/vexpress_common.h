@@ -79,6 +79,7 @@
 #define V2M_SIZE_CS7		V2M_PERIPH_OFFSET(32)
 
 /* System register offsets. */
+#define V2M_SYS_SW		(V2M_SYSREGS + 0x004)
 #define V2M_SYS_CFGDATA		(V2M_SYSREGS + 0x0a0)
 #define V2M_SYS_CFGCTRL		(V2M_SYSREGS + 0x0a4)
 #define V2M_SYS_CFGSTAT		(V2M_SYSREGS + 0x0a8)
@@ -129,6 +130,11 @@
 #define CONFIG_SYS_TIMER_COUNTER	(V2M_TIMER01 + 0x4)
 #define CONFIG_SYS_TIMER_COUNTS_DOWN
 
+/* Route the I/O accessors through iotrace when the command is enabled */
+#ifdef CONFIG_CMD_IOTRACE
+#define CONFIG_IO_TRACE
+#endif
+
 /* PL011 Serial Configuration */
 #define CONFIG_PL011_CLOCK		24000000
 #define CONFIG_PL01x_PORTS		{(void *)CONFIG_SYS_SERIAL0, \
@@ -194,8 +200,34 @@
 		"scriptaddr=0xa8000000\0" \
 		"kernel_addr_r=0xa0008000\0"
 #endif
+
+/*
+ * Function trace (see vexpress_ca9x4_trace_defconfig): just before the OS is
+ * started, the trace data is collected in the second DRAM bank, below the
+ * trace buffers, and saved as trace.bin to the host (with semihosting) or to
+ * the first partition of the SD card.
+ */
+#if defined(CONFIG_TRACE) && defined(CONFIG_VEXPRESS_ORIGINAL_MEMORY_MAP)
+#ifdef CONFIG_SEMIHOSTING
+#define VEXPRESS_TRACE_SAVE	"smhsave trace.bin ${profbase} ${profoffset}"
+#else
+#define VEXPRESS_TRACE_SAVE	"ext4write mmc 0 ${profbase} /trace.bin " \
+				"${profoffset}"
+#endif
+#define VEXPRESS_TRACE_ENV_SETTINGS \
+		"trace_out_addr=0x96000000\0" \
+		"trace_out_size=0x05000000\0" \
+		"trace_dump=trace pause; " \
+			"trace funclist ${trace_out_addr} ${trace_out_size} && " \
+			"trace calls && " VEXPRESS_TRACE_SAVE "\0" \
+		"fakegocmd=run trace_dump\0"
+#else
+#define VEXPRESS_TRACE_ENV_SETTINGS
+#endif
+
 #define CONFIG_EXTRA_ENV_SETTINGS \
 		CONFIG_PLATFORM_ENV_SETTINGS \
+		VEXPRESS_TRACE_ENV_SETTINGS \
                 BOOTENV \
 		"console=ttyAMA0,38400n8\0" \
 		"dram=1024M\0" \
@@ -123,6 +123,10 @@ enum {
  *		When CONFIG_DEVRES is enabled, devm_kmalloc() and friends will
  *		add to this list. Memory so-allocated will be freed
  *		automatically when the device is removed / unbound
+ * @bind_time: Time taken to bind this device in microseconds
+ *		(CONFIG_DM_STATS)
+ * @probe_time: Time taken to probe this device, not counting its parents,
+ *		in microseconds (CONFIG_DM_STATS)
  */
 struct udevice {
 	const struct driver *driver;
@@ -146,6 +150,10 @@ struct udevice {
 #ifdef CONFIG_DEVRES
 	struct list_head devres_head;
 #endif
+#if CONFIG_IS_ENABLED(DM_STATS)
+	ulong bind_time;
+	ulong probe_time;
+#endif
 };
 
 /* Maximum sequence number supported */
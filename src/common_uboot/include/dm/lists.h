@@ -58,6 +58,17 @@ int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
  */
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp);
 
+/**
+ * lists_find_fdt_driver() - find the driver for a device tree node
+ *
+ * This looks up the driver that lists_bind_fdt() would try first for the
+ * node, without binding anything.
+ *
+ * @node: device tree node to check
+ * @return pointer to driver, or NULL if no driver matches the node
+ */
+struct driver *lists_find_fdt_driver(ofnode node);
+
 /**
  * device_bind_driver() - bind a device to a driver
  *
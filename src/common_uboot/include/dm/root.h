@@ -9,6 +9,8 @@
 #ifndef _DM_ROOT_H_
 #define _DM_ROOT_H_
 
+#include <dm/uclass-id.h>
+
 struct udevice;
 
 /**
@@ -30,6 +32,38 @@ struct global_data;
  */
 void dm_fixup_for_gd_move(struct global_data *new_gd);
 
+#if CONFIG_IS_ENABLED(DM_LAZY_BIND)
+/**
+ * dm_lazy_bind_uclass() - Bind devices deferred for a uclass
+ *
+ * With CONFIG_DM_LAZY_BIND, top-level devices are not bound at start-up
+ * but recorded along with the uclass they belong to. This binds all such
+ * devices for the given uclass. It is called by uclass_get() so that
+ * devices appear the first time their uclass is used.
+ *
+ * @id: Uclass ID whose deferred devices should be bound
+ * @return 0 if OK, -ve on error (the first error seen)
+ */
+int dm_lazy_bind_uclass(enum uclass_id id);
+
+/**
+ * dm_lazy_count() - Count devices still waiting to be bound
+ *
+ * @return number of deferred devices not yet bound
+ */
+int dm_lazy_count(void);
+#else
+static inline int dm_lazy_bind_uclass(enum uclass_id id)
+{
+	return 0;
+}
+
+static inline int dm_lazy_count(void)
+{
+	return 0;
+}
+#endif
+
 /**
  * dm_scan_platdata() - Scan all platform data and bind drivers
  *
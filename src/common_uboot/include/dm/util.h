@@ -30,6 +30,15 @@ void dm_dump_all(void);
 /* Dump out a list of uclasses and their devices */
 void dm_dump_uclass(void);
 
+#if CONFIG_IS_ENABLED(DM_STATS)
+/* Dump out bind and probe times for each device */
+void dm_dump_stats(void);
+#else
+static inline void dm_dump_stats(void)
+{
+}
+#endif
+
 #ifdef CONFIG_DEBUG_DEVRES
 /* Dump out a list of device resources */
 void dm_dump_devres(void);
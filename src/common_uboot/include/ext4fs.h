@@ -78,6 +78,10 @@ struct ext4_extent_header {
 	__le32	eh_generation;	/* generation of the tree */
 };
 
+/* Longest initialised extent, and number of extents held in the inode */
+#define EXT4_EXT_INIT_MAX_LEN		(1 << 15)
+#define EXT4_EXT_INODE_MAX		4
+
 struct ext_filesystem {
 	/* Total Sector of partition */
 	uint64_t total_sect;
@@ -104,11 +108,15 @@ struct ext_filesystem {
 	unsigned char **blk_bmaps;
 	long int curr_blkno;
 	uint16_t first_pass_bbmap;
+	/* Set for each block bitmap changed since ext4fs_init() */
+	unsigned char *blk_bmap_dirty;
 
 	/* Inode Bitmap Related */
 	unsigned char **inode_bmaps;
 	int curr_inode_no;
 	uint16_t first_pass_ibmap;
+	/* Set for each inode bitmap changed since ext4fs_init() */
+	unsigned char *inode_bmap_dirty;
 
 	/* Journal Related */
 
@@ -138,6 +146,7 @@ int ext4fs_open(const char *filename, loff_t *len);
 int ext4fs_read(char *buf, loff_t offset, loff_t len, loff_t *actread);
 int ext4fs_mount(unsigned part_length);
 void ext4fs_close(void);
+void ext4fs_umount(void);
 void ext4fs_reinit_global(void);
 int ext4fs_ls(const char *dirname);
 int ext4fs_exists(const char *filename);
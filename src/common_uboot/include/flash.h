@@ -97,6 +97,7 @@ extern void flash_set_verbose(uint);
 extern void flash_protect (int flag, ulong from, ulong to, flash_info_t *info);
 extern int flash_write (char *, ulong, ulong);
 extern flash_info_t *addr2info (ulong);
+void flash_wait_deferred_init(void);
 extern int write_buff (flash_info_t *info, uchar *src, ulong addr, ulong cnt);
 
 /* drivers/mtd/cfi_mtd.c */
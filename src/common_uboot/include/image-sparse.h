@@ -23,6 +23,16 @@ struct sparse_storage {
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
 
+	/*
+	 * Optional: tell the device that the blocks of a DONT_CARE chunk are
+	 * unused, e.g. by erasing them. Only called with
+	 * CONFIG_IMAGE_SPARSE_DISCARD. Returns the number of blocks discarded,
+	 * which may be fewer than blkcnt (e.g. only whole erase groups).
+	 */
+	lbaint_t	(*discard)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
+
 	void		(*mssg)(const char *str, char *response);
 };
 
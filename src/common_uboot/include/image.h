@@ -805,6 +805,20 @@ ulong env_get_bootm_low(void);
 phys_size_t env_get_bootm_size(void);
 phys_size_t env_get_bootm_mapsize(void);
 #endif
+
+/**
+ * memmove_wd() - move a block of memory, resetting the watchdog as it goes
+ *
+ * The areas may overlap. With a watchdog the move is done in pieces of
+ * @chunksz bytes, working downwards when @to is above @from, and the watchdog
+ * is reset before each one. This uses memmove(), which is the optimised
+ * version on architectures which have one (see CONFIG_USE_ARCH_MEMMOVE).
+ *
+ * @to:		Destination address
+ * @from:	Source address
+ * @len:	Number of bytes to move
+ * @chunksz:	Number of bytes to move between watchdog resets
+ */
 void memmove_wd(void *to, void *from, size_t len, ulong chunksz);
 
 static inline int image_check_magic(const image_header_t *hdr)
@@ -1010,6 +1024,8 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
  * @require_keys: Mark all keys as 'required'
  * @engine_id:	Engine to use for signing
  * @cmdname:	Command name used when reporting errors
+ * @incremental: Leave alone images whose data matches their existing hash
+ *		values, and configurations whose signature would not change
  *
  * Adds hash values for all component images in the FIT blob.
  * Hashes are calculated for all component images which have hash subnodes
@@ -1023,7 +1039,8 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp);
  */
 int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 			      const char *comment, int require_keys,
-			      const char *engine_id, const char *cmdname);
+			      const char *engine_id, const char *cmdname,
+			      bool incremental);
 
 int fit_image_verify_with_data(const void *fit, int image_noffset,
 			       const void *data, size_t size);
@@ -6,8 +6,128 @@
 #ifndef __INITCALL_H
 #define __INITCALL_H
 
+#include <linux/list.h>
+
 typedef int (*init_fnc_t)(void);
 
 int initcall_run_list(const init_fnc_t init_sequence[]);
 
+/**
+ * enum initcall_async_state - progress of a deferred initcall
+ *
+ * @INITCALL_ASYNC_IDLE:	Not started yet
+ * @INITCALL_ASYNC_PENDING:	Started, waiting to be run
+ * @INITCALL_ASYNC_RUNNING:	Currently running
+ * @INITCALL_ASYNC_DONE:	Finished, @ret holds the result
+ */
+enum initcall_async_state {
+	INITCALL_ASYNC_IDLE,
+	INITCALL_ASYNC_PENDING,
+	INITCALL_ASYNC_RUNNING,
+	INITCALL_ASYNC_DONE,
+};
+
+/**
+ * struct initcall_async - an initcall which may complete after it is started
+ *
+ * Slow init steps which nothing early in the boot relies upon can be started
+ * from the init sequence and finished later on the boot CPU: while U-Boot
+ * is otherwise idle (see initcall_async_poll()), or at the latest when the
+ * subsystem which it sets up is used (see initcall_async_wait_name()).
+ *
+ * @name:	Name, used for messages and by initcall_async_wait_name()
+ * @func:	Function to call
+ * @state:	Current state (enum initcall_async_state)
+ * @ret:	Return value of @func, valid once @state is
+ *		INITCALL_ASYNC_DONE
+ * @sibling_node:	Node in the list of started initcalls
+ */
+struct initcall_async {
+	const char *name;
+	init_fnc_t func;
+	enum initcall_async_state state;
+	int ret;
+	struct list_head sibling_node;
+};
+
+#ifdef CONFIG_INITCALL_ASYNC
+/**
+ * initcall_async_start() - start a deferred initcall
+ *
+ * The initcall is queued, to be run later. This is only valid after
+ * relocation.
+ *
+ * @ic:		Initcall to start
+ * @return 0 if OK, -EALREADY if it was already started
+ */
+int initcall_async_start(struct initcall_async *ic);
+
+/**
+ * initcall_async_wait() - wait for a deferred initcall to complete
+ *
+ * If the initcall has not run yet it is run now.
+ *
+ * @ic:		Initcall to wait for
+ * @return return value of the initcall, -ENOENT if it was never started,
+ * -EDEADLK if called from within the initcall itself
+ */
+int initcall_async_wait(struct initcall_async *ic);
+
+/**
+ * initcall_async_wait_name() - wait for a deferred initcall by name
+ *
+ * This is for subsystems whose setup the init sequence may have deferred,
+ * to call before they look up a device. It does nothing if no initcall of
+ * that name was started.
+ *
+ * @name:	Name of the initcall, e.g. "initr_mmc"
+ * @return as initcall_async_wait(), or 0 if there is no such initcall
+ */
+int initcall_async_wait_name(const char *name);
+
+/**
+ * initcall_async_wait_all() - wait for all started initcalls to complete
+ *
+ * @return 0 if all succeeded, else the first error seen
+ */
+int initcall_async_wait_all(void);
+
+/**
+ * initcall_async_pending() - check for initcalls which could run now
+ *
+ * @return true if initcall_async_poll() has something to do
+ */
+bool initcall_async_pending(void);
+
+/**
+ * initcall_async_poll() - run one queued initcall
+ *
+ * This is intended for places where U-Boot would otherwise just delay, such
+ * as the autoboot countdown.
+ *
+ * @return true if an initcall was run, false if there was nothing ready
+ */
+bool initcall_async_poll(void);
+#else
+static inline int initcall_async_wait_name(const char *name)
+{
+	return 0;
+}
+
+static inline int initcall_async_wait_all(void)
+{
+	return 0;
+}
+
+static inline bool initcall_async_pending(void)
+{
+	return false;
+}
+
+static inline bool initcall_async_poll(void)
+{
+	return false;
+}
+#endif
+
 #endif
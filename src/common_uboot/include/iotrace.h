@@ -25,17 +25,68 @@ enum iotrace_flags {
  * struct iotrace_record - Holds a single I/O trace record
  *
  * @flags: I/O access type
+ * @latency: Time taken by the access in ticks (see struct iotrace_window)
  * @timestamp: Timestamp of access
  * @addr: Address of access
  * @value: Value written or read
  */
 struct iotrace_record {
 	enum iotrace_flags flags;
+	u32 latency;
 	u64 timestamp;
 	phys_addr_t addr;
 	iovalue_t value;
 };
 
+/* Maximum number of statistics windows */
+#define IOTRACE_MAX_WINDOWS	8
+
+/* Number of latency histogram buckets (powers of two) */
+#define IOTRACE_HIST_BUCKETS	16
+
+/**
+ * struct iotrace_window - access statistics for an I/O address range
+ *
+ * While iotrace is enabled, each access to the range is counted, whether or
+ * not there is room for a trace record. Times are in ticks, which are CPU
+ * cycles with CONFIG_IO_TRACE_CYCLE_COUNTER, otherwise timer ticks.
+ *
+ * @name: Name of the window, e.g. the peripheral it covers
+ * @start: Start address of the window
+ * @size: Size of the window in bytes
+ * @reads: Number of reads
+ * @writes: Number of writes
+ * @ticks: Total time taken by all accesses
+ * @max_ticks: Longest time taken by an access
+ * @polls: Number of reads which returned the same value as the previous
+ *	read of the same address, with no write in between; these are nearly
+ *	always a loop waiting for a status bit
+ * @max_poll_run: Longest run of such reads (including the first)
+ * @max_poll_addr: Address read by the longest run
+ * @hist: Latency histogram: bucket 0 counts accesses taking 0 ticks, and
+ *	bucket n counts those taking 2^(n-1) to 2^n - 1 ticks (the last
+ *	bucket also counts anything longer)
+ * @last_addr: Address of the previous read (internal)
+ * @last_value: Value of the previous read (internal)
+ * @poll_run: Length of the current run of repeated reads (internal)
+ */
+struct iotrace_window {
+	char name[16];
+	ulong start;
+	ulong size;
+	ulong reads;
+	ulong writes;
+	u64 ticks;
+	ulong max_ticks;
+	ulong polls;
+	ulong max_poll_run;
+	ulong max_poll_addr;
+	ulong hist[IOTRACE_HIST_BUCKETS];
+	ulong last_addr;
+	ulong last_value;
+	ulong poll_run;
+};
+
 /*
  * This file is designed to be included in arch/<arch>/include/asm/io.h.
  * It redirects all IO access through a tracing/checksumming feature for
@@ -154,4 +205,38 @@ void iotrace_set_buffer(ulong start, ulong size);
  */
 void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *offset, ulong *count);
 
+/**
+ * iotrace_add_window() - Add a statistics window
+ *
+ * Accesses are counted against the first window which contains them.
+ * Accesses outside all the windows are counted in the "other" window, which
+ * always exists and comes after the ones added here.
+ *
+ * @name: Name of the window (truncated to 15 characters)
+ * @start: Start address of the window
+ * @size: Size of the window in bytes
+ * @return index of the new window, -EINVAL if @size is 0, or -ENOSPC if
+ * there are already IOTRACE_MAX_WINDOWS windows
+ */
+int iotrace_add_window(const char *name, ulong start, ulong size);
+
+/**
+ * iotrace_clear_windows() - Remove all statistics windows
+ */
+void iotrace_clear_windows(void);
+
+/**
+ * iotrace_reset_stats() - Zero the statistics of all windows
+ */
+void iotrace_reset_stats(void);
+
+/**
+ * iotrace_get_window() - Get a statistics window
+ *
+ * @index: Index of the window (0 for the first); the index after the last
+ *	added window gives the "other" window
+ * @return the window, or NULL if there is no window with that index
+ */
+const struct iotrace_window *iotrace_get_window(int index);
+
 #endif /* __IOTRACE_H */
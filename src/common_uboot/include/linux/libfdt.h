@@ -305,6 +305,109 @@ int fdt_next_region(const void *fdt,
  */
 int fdt_add_alias_regions(const void *fdt, struct fdt_region *region, int count,
 			  int max_regions, struct fdt_region_state *info);
+
+#ifndef USE_HOSTCC
+#if CONFIG_IS_ENABLED(OF_LIBFDT_INDEX)
+/**
+ * fdt_index_find_phandle() - look up a phandle in the FDT index
+ *
+ * The index only covers the control FDT (gd->fdt_blob) once full malloc()
+ * is available. It is built on first use and dropped whenever that tree is
+ * modified.
+ *
+ * @fdt:	Device tree to search
+ * @phandle:	Phandle to look for
+ * @offsetp:	Returns the offset of the first node with that phandle, or
+ *		-FDT_ERR_NOTFOUND
+ * @return true if the index answered, false if the caller must search the
+ * tree itself
+ */
+bool fdt_index_find_phandle(const void *fdt, uint32_t phandle, int *offsetp);
+
+/**
+ * fdt_index_find_compatible() - look up a compatible string in the index
+ *
+ * @fdt:	Device tree to search
+ * @startoffset: Only nodes after this offset are considered (-1 for all)
+ * @compatible:	Compatible string to look for
+ * @offsetp:	Returns the offset of the first matching node, or
+ *		-FDT_ERR_NOTFOUND
+ * @return true if the index answered, false if the caller must search
+ */
+bool fdt_index_find_compatible(const void *fdt, int startoffset,
+			       const char *compatible, int *offsetp);
+
+/**
+ * fdt_index_find_path() - look up a path in the path cache
+ *
+ * @fdt:	Device tree to search
+ * @path:	Path (or alias) to look for
+ * @namelen:	Number of characters of @path to use
+ * @offsetp:	Returns the cached result of fdt_path_offset_namelen()
+ * @return true if the result was cached, false if not
+ */
+bool fdt_index_find_path(const void *fdt, const char *path, int namelen,
+			 int *offsetp);
+
+/**
+ * fdt_index_add_path() - remember the result of a path lookup
+ *
+ * @fdt:	Device tree which was searched
+ * @path:	Path (or alias) which was looked up
+ * @namelen:	Number of characters of @path used
+ * @offset:	Result of the lookup
+ */
+void fdt_index_add_path(const void *fdt, const char *path, int namelen,
+			int offset);
+
+/**
+ * fdt_index_invalidate() - drop the index for a device tree
+ *
+ * This is called by the libfdt functions which modify a tree. It does
+ * nothing if @fdt is not the indexed tree.
+ *
+ * @fdt:	Device tree which is about to change
+ */
+void fdt_index_invalidate(const void *fdt);
+
+/**
+ * fdt_index_set_enabled() - turn use of the index on or off
+ *
+ * This is mostly useful for comparing indexed and linear lookups.
+ *
+ * @enable:	true to use the index, false to always search the tree
+ */
+void fdt_index_set_enabled(bool enable);
+#else
+static inline bool fdt_index_find_phandle(const void *fdt, uint32_t phandle,
+					  int *offsetp)
+{
+	return false;
+}
+
+static inline bool fdt_index_find_compatible(const void *fdt, int startoffset,
+					     const char *compatible,
+					     int *offsetp)
+{
+	return false;
+}
+
+static inline bool fdt_index_find_path(const void *fdt, const char *path,
+				       int namelen, int *offsetp)
+{
+	return false;
+}
+
+static inline void fdt_index_add_path(const void *fdt, const char *path,
+				      int namelen, int offset)
+{
+}
+
+static inline void fdt_index_invalidate(const void *fdt)
+{
+}
+#endif
+#endif /* USE_HOSTCC */
 #endif /* SWIG */
 
 extern struct fdt_header *working_fdt;  /* Pointer to the working fdt */
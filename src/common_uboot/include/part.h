@@ -269,6 +269,8 @@ struct part_driver {
 	 * @dev_desc:	Block device descriptor
 	 * @part:	Partition number (1 = first)
 	 * @info:	Returns partition information
+	 * @return 0 if OK, -ENOENT if the partition table was read and does
+	 *	not have this partition, other -ve on error
 	 */
 	int (*get_info)(struct blk_desc *dev_desc, int part,
 			disk_partition_t *info);
@@ -285,7 +287,7 @@ struct part_driver {
 	 *
 	 * @dev_desc:	Block device descriptor
 	 * @return 0 if the block device appears to contain this partition
-	 *	   type, -ve if not
+	 *	   type, -EIO if the device could not be read, other -ve if not
 	 */
 	int (*test)(struct blk_desc *dev_desc);
 };
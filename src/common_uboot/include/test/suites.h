@@ -26,6 +26,10 @@ int cmd_ut_category(const char *name, struct unit_test *tests, int n_ents,
 int do_ut_dm(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 int do_ut_env(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 int do_ut_overlay(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
+int do_ut_aes(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
+int do_ut_fdt_index(cmd_tbl_t *cmdtp, int flag, int argc,
+		    char * const argv[]);
+int do_ut_rsa(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 int do_ut_time(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 int do_ut_compression(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[]);
 
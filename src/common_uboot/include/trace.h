@@ -55,7 +55,8 @@ void trace_print_stats(void);
  * @param buff		Buffer in which to place data, or NULL to count size
  * @param buff_size	Size of buffer
  * @param needed	Returns number of bytes used / needed
- * @return 0 if ok, -1 on error (buffer exhausted)
+ * @return 0 if ok, -1 on error (buffer exhausted), -ENOENT if there is no
+ * trace data
  */
 int trace_list_functions(void *buff, int buff_size, unsigned *needed);
 
@@ -64,13 +65,20 @@ enum ftrace_flags {
 	FUNCF_EXIT		= 0UL << 30,
 	FUNCF_ENTRY		= 1UL << 30,
 	FUNCF_TEXTBASE		= 2UL << 30,
+	FUNCF_SAMPLE		= 3UL << 30,	/* Function on sampled stack */
 
 	FUNCF_TIMESTAMP_MASK	= 0x3fffffff,
 };
 
 #define TRACE_CALL_TYPE(call)	((call)->flags & 0xc0000000UL)
 
-/* Information about a single function entry/exit */
+/*
+ * Information about a single function entry/exit
+ *
+ * When sampling, each sample of the call stack is a series of FUNCF_SAMPLE
+ * records, one for each function starting with the outermost. In these the
+ * caller field gives the position in the stack, starting at 0.
+ */
 struct trace_call {
 	uint32_t func;		/* Function offset */
 	uint32_t caller;	/* Caller function offset */
@@ -88,6 +96,49 @@ int trace_list_calls(void *buff, int buff_size, unsigned int *needed);
  */
 void trace_set_enabled(int enabled);
 
+/**
+ * trace_set_depth_limit() - Set the maximum call depth which is recorded
+ *
+ * Calls which are nested more deeply than this are counted, but not
+ * recorded in the call list.
+ *
+ * @limit:	New depth limit
+ * @return 0 if OK, -ENOENT if trace has not been initialised
+ */
+int trace_set_depth_limit(int limit);
+
+/**
+ * trace_set_sample_us() - Record call stack samples instead of every call
+ *
+ * In sampling mode the call stack is recorded on the first function entry or
+ * exit after each sampling period. This produces much less data than
+ * recording every call, at the cost of detail.
+ *
+ * @period_us:	Sampling period in microseconds, or 0 to record every call
+ * @return 0 if OK, -ENOENT if trace has not been initialised
+ */
+int trace_set_sample_us(ulong period_us);
+
+/**
+ * trace_set_filter() - Select whether calls to a function are recorded
+ *
+ * Calls to a function which is filtered out are still counted.
+ *
+ * @addr:	Address of the function, as given in System.map
+ * @traced:	1 to record calls to the function, 0 to leave them out
+ * @return 0 if OK, -ENOENT if trace has not been initialised, -EINVAL if
+ * the address is not within U-Boot
+ */
+int trace_set_filter(ulong addr, int traced);
+
+/**
+ * trace_set_filter_all() - Select whether calls to all functions are recorded
+ *
+ * @traced:	1 to record all calls, 0 to record none
+ * @return 0 if OK, -ENOENT if trace has not been initialised
+ */
+int trace_set_filter_all(int traced);
+
 int trace_early_init(void);
 
 /**
@@ -98,6 +149,8 @@ int trace_early_init(void);
  *
  * @param buff		Pointer to trace buffer
  * @param buff_size	Size of trace buffer
+ * @return 0 if ok, -ENOMEM if the buffer is at CONFIG_TRACE_BUFFER_ADDR but
+ * that is not in DRAM, -1 on other error
  */
 int trace_init(void *buff, size_t buff_size);
 
@@ -31,4 +31,18 @@ void crc32_wd_buf(const unsigned char *input, uint ilen,
 void crc32c_init(uint32_t *, uint32_t);
 uint32_t crc32c_cal(uint32_t, const char *, int, uint32_t *);
 
+/**
+ * crc32c() - calculate a CRC32C (Castagnoli) checksum
+ *
+ * This uses built-in tables and handles eight bytes per step, so there is no
+ * need for crc32c_init(). As with crc32c_cal(), the CRC is neither inverted
+ * on entry nor on exit.
+ *
+ * @crc:	Starting CRC, usually ~0
+ * @data:	Data to checksum
+ * @length:	Number of bytes of @data
+ * @return updated CRC
+ */
+uint32_t crc32c(uint32_t crc, const void *data, unsigned int length);
+
 #endif /* _UBOOT_CRC_H */
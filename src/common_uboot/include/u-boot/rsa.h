@@ -97,6 +97,21 @@ static inline int rsa_add_verify_data(struct image_sign_info *info,
 int rsa_verify(struct image_sign_info *info,
 	       const struct image_region region[], int region_count,
 	       uint8_t *sig, uint sig_len);
+
+/**
+ * rsa_verify_hash() - Verify a signature against a hash
+ *
+ * This is rsa_verify() for a hash which has already been calculated with
+ * @info->checksum.
+ *
+ * @info:	Specifies key and FIT information
+ * @hash:	Hash of the signed data
+ * @sig:	Signature
+ * @sig_len:	Number of bytes in signature
+ * @return 0 if verified, -ve on error
+ */
+int rsa_verify_hash(struct image_sign_info *info, const uint8_t *hash,
+		    uint8_t *sig, uint sig_len);
 #else
 static inline int rsa_verify(struct image_sign_info *info,
 		const struct image_region region[], int region_count,
@@ -104,6 +119,13 @@ static inline int rsa_verify(struct image_sign_info *info,
 {
 	return -ENXIO;
 }
+
+static inline int rsa_verify_hash(struct image_sign_info *info,
+				  const uint8_t *hash, uint8_t *sig,
+				  uint sig_len)
+{
+	return -ENXIO;
+}
 #endif
 
 #define RSA2048_BYTES	(2048 / 8)
@@ -42,30 +42,167 @@
 #include <part.h>
 #include <sparse_format.h>
 
+#include <linux/err.h>
 #include <linux/math64.h>
 
 static void default_log(const char *ignored, char *response) {}
 
+/*
+ * Chunks smaller than the staging buffer are gathered in it and written
+ * together, so that an image made of many small chunks is not written a
+ * few blocks at a time. Larger chunks are written straight from the image
+ * (RAW) or from a buffer holding the fill pattern (FILL).
+ */
+
+/**
+ * struct sparse_out - state of the output device
+ *
+ * @blk:	Block where the data in @buf goes, i.e. the next block to write
+ * @buf:	Staging buffer, @buf_blks blocks
+ * @buf_blks:	Size of @buf in blocks
+ * @cnt:	Number of blocks of data waiting in @buf
+ * @fill_buf:	Buffer holding the fill pattern, @buf_blks blocks
+ * @fill_val:	Fill pattern held in @fill_buf
+ * @fill_blks:	Number of blocks of @fill_buf holding @fill_val
+ */
+struct sparse_out {
+	lbaint_t blk;
+	void *buf;
+	lbaint_t buf_blks;
+	lbaint_t cnt;
+	uint32_t *fill_buf;
+	uint32_t fill_val;
+	lbaint_t fill_blks;
+};
+
+/**
+ * sparse_write() - write blocks to the device
+ *
+ * @info:	Storage to write to
+ * @out:	Output state; @out->blk is moved on past the blocks written
+ * @blkcnt:	Number of blocks to write
+ * @buf:	Data to write
+ * @response:	Response buffer for error messages
+ * @return 0 if OK, -1 on error
+ */
+static int sparse_write(struct sparse_storage *info, struct sparse_out *out,
+			lbaint_t blkcnt, const void *buf, char *response)
+{
+	lbaint_t blks;
+
+	blks = info->write(info, out->blk, blkcnt, buf);
+	/* blks might be > blkcnt (eg. NAND bad-blocks) */
+	if (blks < blkcnt) {
+		printf("%s: %s" LBAFU " [" LBAFU "]\n", __func__,
+		       "Write failed, block #", out->blk, blks);
+		info->mssg("flash write failure", response);
+		return -1;
+	}
+	out->blk += blks;
+
+	return 0;
+}
+
+/**
+ * sparse_flush() - write out the blocks waiting in the staging buffer
+ *
+ * @info:	Storage to write to
+ * @out:	Output state
+ * @response:	Response buffer for error messages
+ * @return 0 if OK, -1 on error
+ */
+static int sparse_flush(struct sparse_storage *info, struct sparse_out *out,
+			char *response)
+{
+	lbaint_t cnt = out->cnt;
+
+	if (!cnt)
+		return 0;
+	out->cnt = 0;
+
+	return sparse_write(info, out, cnt, out->buf, response);
+}
+
+/**
+ * sparse_stage() - make room in the staging buffer
+ *
+ * Writes out the staging buffer if @blkcnt more blocks do not fit in it.
+ *
+ * @info:	Storage to write to
+ * @out:	Output state
+ * @blkcnt:	Number of blocks needed
+ * @response:	Response buffer for error messages
+ * @return pointer to the space in the staging buffer, NULL if the chunk is
+ * too large for it, ERR_PTR(-EIO) on error
+ */
+static void *sparse_stage(struct sparse_storage *info, struct sparse_out *out,
+			  lbaint_t blkcnt, char *response)
+{
+	void *ptr;
+
+	if (out->cnt + blkcnt > out->buf_blks &&
+	    sparse_flush(info, out, response))
+		return ERR_PTR(-EIO);
+	if (blkcnt >= out->buf_blks)
+		return NULL;
+	ptr = out->buf + out->cnt * info->blksz;
+	out->cnt += blkcnt;
+
+	return ptr;
+}
+
+/**
+ * sparse_fill() - write a fill pattern to the device
+ *
+ * @info:	Storage to write to
+ * @out:	Output state, with nothing waiting in the staging buffer
+ * @blkcnt:	Number of blocks to write
+ * @fill_val:	Value to write to each 32-bit word
+ * @response:	Response buffer for error messages
+ * @return 0 if OK, -1 on error
+ */
+static int sparse_fill(struct sparse_storage *info, struct sparse_out *out,
+		       lbaint_t blkcnt, uint32_t fill_val, char *response)
+{
+	lbaint_t need = min(blkcnt, out->buf_blks);
+	lbaint_t i, j;
+
+	/* The pattern is kept from one chunk to the next */
+	if (fill_val != out->fill_val)
+		out->fill_blks = 0;
+	if (out->fill_blks < need) {
+		for (i = out->fill_blks * info->blksz / sizeof(fill_val);
+		     i < need * info->blksz / sizeof(fill_val); i++)
+			out->fill_buf[i] = fill_val;
+		out->fill_val = fill_val;
+		out->fill_blks = need;
+	}
+
+	for (i = 0; i < blkcnt; i += j) {
+		j = min(blkcnt - i, out->buf_blks);
+		if (sparse_write(info, out, j, out->fill_buf, response))
+			return -1;
+	}
+
+	return 0;
+}
+
 int write_sparse_image(struct sparse_storage *info,
 		       const char *part_name, void *data, char *response)
 {
-	lbaint_t blk;
+	struct sparse_out out = { 0 };
 	lbaint_t blkcnt;
-	lbaint_t blks;
 	uint32_t bytes_written = 0;
 	unsigned int chunk;
 	unsigned int offset;
 	unsigned int chunk_data_sz;
-	uint32_t *fill_buf = NULL;
 	uint32_t fill_val;
 	sparse_header_t *sparse_header;
 	chunk_header_t *chunk_header;
 	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
+	void *ptr;
+	int ret = -1;
 	int i;
-	int j;
-
-	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
 
 	/* Read and skip over sparse image header */
 	sparse_header = (sparse_header_t *)data;
@@ -104,10 +241,23 @@ int write_sparse_image(struct sparse_storage *info,
 		return -1;
 	}
 
+	out.buf_blks = max_t(lbaint_t, 1,
+			     CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz);
+	out.buf = memalign(ARCH_DMA_MINALIGN,
+			   ROUNDUP(info->blksz * out.buf_blks,
+				   ARCH_DMA_MINALIGN));
+	out.fill_buf = memalign(ARCH_DMA_MINALIGN,
+				ROUNDUP(info->blksz * out.buf_blks,
+					ARCH_DMA_MINALIGN));
+	if (!out.buf || !out.fill_buf) {
+		info->mssg("Malloc failed for sparse image buffers", response);
+		goto out;
+	}
+
 	puts("Flashing Sparse Image\n");
 
 	/* Start processing chunks */
-	blk = info->start;
+	out.blk = info->start;
 	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
 		/* Read and skip over chunk header */
 		chunk_header = (chunk_header_t *)data;
@@ -137,28 +287,27 @@ int write_sparse_image(struct sparse_storage *info,
 			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
 				info->mssg("Bogus chunk size for chunk type Raw",
 					   response);
-				return -1;
+				goto out;
 			}
 
-			if (blk + blkcnt > info->start + info->size) {
+			if (out.blk + out.cnt + blkcnt >
+			    info->start + info->size) {
 				printf(
 				    "%s: Request would exceed partition size!\n",
 				    __func__);
 				info->mssg("Request would exceed partition size!",
 					   response);
-				return -1;
+				goto out;
 			}
 
-			blks = info->write(info, blk, blkcnt, data);
-			/* blks might be > blkcnt (eg. NAND bad-blocks) */
-			if (blks < blkcnt) {
-				printf("%s: %s" LBAFU " [" LBAFU "]\n",
-				       __func__, "Write failed, block #",
-				       blk, blks);
-				info->mssg("flash write failure", response);
-				return -1;
-			}
-			blk += blks;
+			ptr = sparse_stage(info, &out, blkcnt, response);
+			if (IS_ERR(ptr))
+				goto out;
+			if (ptr)
+				memcpy(ptr, data, chunk_data_sz);
+			else if (sparse_write(info, &out, blkcnt, data,
+					      response))
+				goto out;
 			bytes_written += blkcnt * info->blksz;
 			total_blocks += chunk_header->chunk_sz;
 			data += chunk_data_sz;
@@ -168,64 +317,44 @@ int write_sparse_image(struct sparse_storage *info,
 			if (chunk_header->total_sz !=
 			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
 				info->mssg("Bogus chunk size for chunk type FILL", response);
-				return -1;
-			}
-
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
+				goto out;
 			}
 
 			fill_val = *(uint32_t *)data;
 			data = (char *)data + sizeof(uint32_t);
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
-
-			if (blk + blkcnt > info->start + info->size) {
+			if (out.blk + out.cnt + blkcnt >
+			    info->start + info->size) {
 				printf(
 				    "%s: Request would exceed partition size!\n",
 				    __func__);
 				info->mssg("Request would exceed partition size!",
 					   response);
-				return -1;
+				goto out;
 			}
 
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
-						   response);
-					free(fill_buf);
-					return -1;
-				}
-				blk += blks;
-				i += j;
+			ptr = sparse_stage(info, &out, blkcnt, response);
+			if (IS_ERR(ptr))
+				goto out;
+			if (ptr) {
+				for (i = 0; i < chunk_data_sz / sizeof(fill_val);
+				     i++)
+					((uint32_t *)ptr)[i] = fill_val;
+			} else if (sparse_fill(info, &out, blkcnt, fill_val,
+					       response)) {
+				goto out;
 			}
 			bytes_written += blkcnt * info->blksz;
 			total_blocks += chunk_data_sz / sparse_header->blk_sz;
-			free(fill_buf);
 			break;
 
 		case CHUNK_TYPE_DONT_CARE:
-			blk += info->reserve(info, blk, blkcnt);
+			if (sparse_flush(info, &out, response))
+				goto out;
+			if (IS_ENABLED(CONFIG_IMAGE_SPARSE_DISCARD) &&
+			    info->discard)
+				info->discard(info, out.blk, blkcnt);
+			out.blk += info->reserve(info, out.blk, blkcnt);
 			total_blocks += chunk_header->chunk_sz;
 			break;
 
@@ -234,7 +363,7 @@ int write_sparse_image(struct sparse_storage *info,
 			    sparse_header->chunk_hdr_sz) {
 				info->mssg("Bogus chunk size for chunk type Dont Care",
 					   response);
-				return -1;
+				goto out;
 			}
 			total_blocks += chunk_header->chunk_sz;
 			data += chunk_data_sz;
@@ -244,9 +373,11 @@ int write_sparse_image(struct sparse_storage *info,
 			printf("%s: Unknown chunk type: %x\n", __func__,
 			       chunk_header->chunk_type);
 			info->mssg("Unknown chunk type", response);
-			return -1;
+			goto out;
 		}
 	}
+	if (sparse_flush(info, &out, response))
+		goto out;
 
 	debug("Wrote %d blocks, expected to write %d blocks\n",
 	      total_blocks, sparse_header->total_blks);
@@ -254,8 +385,13 @@ int write_sparse_image(struct sparse_storage *info,
 
 	if (total_blocks != sparse_header->total_blks) {
 		info->mssg("sparse image write failure", response);
-		return -1;
+		goto out;
 	}
+	ret = 0;
 
-	return 0;
+out:
+	free(out.fill_buf);
+	free(out.buf);
+
+	return ret;
 }
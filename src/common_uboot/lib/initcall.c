@@ -6,6 +6,7 @@
 #include <common.h>
 #include <initcall.h>
 #include <efi.h>
+#include <watchdog.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -37,3 +38,118 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 	}
 	return 0;
 }
+
+#ifdef CONFIG_INITCALL_ASYNC
+/* Initcalls started by initcall_async_start(), in start order */
+static LIST_HEAD(initcall_async_list);
+
+/* Number of started initcalls which have not completed */
+static int initcall_async_outstanding;
+
+static int initcall_async_run(struct initcall_async *ic)
+{
+	int ret;
+
+	debug("initcall: async %s\n", ic->name);
+	ic->state = INITCALL_ASYNC_RUNNING;
+	ret = ic->func();
+	if (ret)
+		printf("initcall %s failed (err=%d)\n", ic->name, ret);
+	ic->ret = ret;
+	ic->state = INITCALL_ASYNC_DONE;
+	initcall_async_outstanding--;
+
+	return ret;
+}
+
+int initcall_async_start(struct initcall_async *ic)
+{
+	if (ic->state != INITCALL_ASYNC_IDLE)
+		return -EALREADY;
+
+	ic->state = INITCALL_ASYNC_PENDING;
+	ic->ret = 0;
+	list_add_tail(&ic->sibling_node, &initcall_async_list);
+	initcall_async_outstanding++;
+
+	return 0;
+}
+
+int initcall_async_wait(struct initcall_async *ic)
+{
+	switch (ic->state) {
+	case INITCALL_ASYNC_IDLE:
+		return -ENOENT;
+	case INITCALL_ASYNC_DONE:
+		return ic->ret;
+	case INITCALL_ASYNC_RUNNING:
+		return -EDEADLK;
+	case INITCALL_ASYNC_PENDING:
+		break;
+	}
+
+	return initcall_async_run(ic);
+}
+
+int initcall_async_wait_name(const char *name)
+{
+	struct initcall_async *ic;
+
+	list_for_each_entry(ic, &initcall_async_list, sibling_node) {
+		if (!strcmp(ic->name, name))
+			return initcall_async_wait(ic);
+	}
+
+	return 0;
+}
+
+int initcall_async_wait_all(void)
+{
+	struct initcall_async *ic;
+	int first_err = 0;
+	int ret;
+
+	if (!initcall_async_outstanding)
+		return 0;
+
+	list_for_each_entry(ic, &initcall_async_list, sibling_node) {
+		ret = initcall_async_wait(ic);
+		if (ret && ret != -EDEADLK && !first_err)
+			first_err = ret;
+	}
+
+	return first_err;
+}
+
+bool initcall_async_pending(void)
+{
+	struct initcall_async *ic;
+
+	if (!initcall_async_outstanding)
+		return false;
+
+	list_for_each_entry(ic, &initcall_async_list, sibling_node) {
+		if (ic->state == INITCALL_ASYNC_PENDING)
+			return true;
+	}
+
+	return false;
+}
+
+bool initcall_async_poll(void)
+{
+	struct initcall_async *ic;
+
+	if (!initcall_async_outstanding)
+		return false;
+
+	list_for_each_entry(ic, &initcall_async_list, sibling_node) {
+		if (ic->state == INITCALL_ASYNC_PENDING) {
+			initcall_async_run(ic);
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif /* CONFIG_INITCALL_ASYNC */
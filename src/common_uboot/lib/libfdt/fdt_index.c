@@ -0,0 +1,419 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Lookup index for the control device tree
+ *
+ * libfdt finds nodes by phandle, compatible string or path by scanning the
+ * tree from the top each time. This builds, in one pass over the tree, a
+ * sorted phandle table and a table of compatible strings sorted by hash, and
+ * keeps a small cache of path lookups. Only the control FDT (gd->fdt_blob) is
+ * indexed, and only once full malloc() is available. Any modification to
+ * the tree through libfdt drops the index, which is rebuilt on next use.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Number of entries in the path cache (must be a power of two) */
+#define FDT_INDEX_PATH_SLOTS	32
+
+/**
+ * struct fdt_index_phandle - phandle table entry
+ *
+ * @phandle:	Phandle of the node
+ * @offset:	Offset of the node
+ */
+struct fdt_index_phandle {
+	uint32_t phandle;
+	int offset;
+};
+
+/**
+ * struct fdt_index_compat - compatible string table entry
+ *
+ * The table is sorted by hash, then string, then node offset, so all the
+ * nodes with a given compatible string form a run which is in node order.
+ *
+ * @str:	Compatible string, pointing into the tree
+ * @hash:	Hash of @str
+ * @offset:	Offset of the node
+ */
+struct fdt_index_compat {
+	const char *str;
+	uint32_t hash;
+	int offset;
+};
+
+/**
+ * struct fdt_index_path - path cache entry
+ *
+ * @path:	Copy of the path looked up (allocated), or NULL if unused
+ * @len:	Length of @path
+ * @offset:	Result of the lookup
+ */
+struct fdt_index_path {
+	char *path;
+	int len;
+	int offset;
+};
+
+/**
+ * struct fdt_index - lookup index for a device tree
+ *
+ * @fdt:		Device tree which is indexed
+ * @phandles:		Phandle table, sorted by phandle then offset
+ * @phandle_count:	Number of entries in @phandles
+ * @compats:		Compatible string table
+ * @compat_count:	Number of entries in @compats
+ * @paths:		Path cache, indexed by path hash
+ */
+struct fdt_index {
+	const void *fdt;
+	struct fdt_index_phandle *phandles;
+	int phandle_count;
+	struct fdt_index_compat *compats;
+	int compat_count;
+	struct fdt_index_path paths[FDT_INDEX_PATH_SLOTS];
+};
+
+static struct fdt_index *fdt_idx;
+static bool fdt_idx_disabled;
+
+/* FNV-1a, which is quick and good enough for short strings */
+static uint32_t fdt_index_hash(const char *str, int len)
+{
+	uint32_t hash = 2166136261u;
+
+	while (len--) {
+		hash ^= (uchar)*str++;
+		hash *= 16777619;
+	}
+
+	return hash;
+}
+
+static void fdt_index_free(struct fdt_index *idx)
+{
+	int i;
+
+	for (i = 0; i < FDT_INDEX_PATH_SLOTS; i++)
+		free(idx->paths[i].path);
+	free(idx->compats);
+	free(idx->phandles);
+	free(idx);
+}
+
+static int fdt_index_phandle_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_phandle *pa = a, *pb = b;
+
+	if (pa->phandle != pb->phandle)
+		return pa->phandle < pb->phandle ? -1 : 1;
+
+	return pa->offset - pb->offset;
+}
+
+static int fdt_index_compat_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_compat *ca = a, *cb = b;
+	int ret;
+
+	if (ca->hash != cb->hash)
+		return ca->hash < cb->hash ? -1 : 1;
+	ret = strcmp(ca->str, cb->str);
+	if (ret)
+		return ret;
+
+	return ca->offset - cb->offset;
+}
+
+/**
+ * fdt_index_grow() - make room for another table entry
+ *
+ * @tablep:	Pointer to the table, updated if it moves
+ * @allocp:	Pointer to the number of entries allocated, updated
+ * @count:	Number of entries in use
+ * @size:	Size of each entry
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+static int fdt_index_grow(void **tablep, int *allocp, int count, size_t size)
+{
+	void *table;
+	int alloc;
+
+	if (count < *allocp)
+		return 0;
+	alloc = *allocp ? *allocp * 2 : 32;
+	table = realloc(*tablep, alloc * size);
+	if (!table)
+		return -ENOMEM;
+	*tablep = table;
+	*allocp = alloc;
+
+	return 0;
+}
+
+/**
+ * fdt_index_scan() - fill in the phandle and compatible tables
+ *
+ * @idx:	Index to fill in
+ * @return 0 if OK, -ENOMEM if out of memory, or a libfdt error if the
+ * tree is broken
+ */
+static int fdt_index_scan(struct fdt_index *idx)
+{
+	const void *fdt = idx->fdt;
+	int phandle_alloc = 0, compat_alloc = 0;
+	int offset;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		const char *list, *end;
+		uint32_t phandle;
+		int len;
+
+		phandle = fdt_get_phandle(fdt, offset);
+		if (phandle && phandle != (uint32_t)-1) {
+			struct fdt_index_phandle *ph;
+
+			if (fdt_index_grow((void **)&idx->phandles,
+					   &phandle_alloc, idx->phandle_count,
+					   sizeof(*ph)))
+				return -ENOMEM;
+			ph = &idx->phandles[idx->phandle_count++];
+			ph->phandle = phandle;
+			ph->offset = offset;
+		}
+
+		list = fdt_getprop(fdt, offset, "compatible", &len);
+		if (!list)
+			continue;
+		for (end = list + len; list < end; list += len + 1) {
+			struct fdt_index_compat *entry;
+
+			len = strnlen(list, end - list);
+			if (fdt_index_grow((void **)&idx->compats,
+					   &compat_alloc, idx->compat_count,
+					   sizeof(*entry)))
+				return -ENOMEM;
+			entry = &idx->compats[idx->compat_count++];
+			entry->str = list;
+			entry->hash = fdt_index_hash(list, len);
+			entry->offset = offset;
+		}
+	}
+	if (offset != -FDT_ERR_NOTFOUND)
+		return offset;
+
+	return 0;
+}
+
+static struct fdt_index *fdt_index_build(const void *fdt)
+{
+	struct fdt_index *idx;
+	int ret;
+
+	idx = calloc(1, sizeof(*idx));
+	if (!idx)
+		return NULL;
+	idx->fdt = fdt;
+
+	ret = fdt_index_scan(idx);
+	if (ret)
+		goto err;
+
+	qsort(idx->phandles, idx->phandle_count, sizeof(*idx->phandles),
+	      fdt_index_phandle_cmp);
+	qsort(idx->compats, idx->compat_count, sizeof(*idx->compats),
+	      fdt_index_compat_cmp);
+	debug("fdt_index: %d phandles, %d compatible strings\n",
+	      idx->phandle_count, idx->compat_count);
+
+	return idx;
+
+err:
+	debug("fdt_index: cannot build index (err=%d)\n", ret);
+	fdt_index_free(idx);
+
+	return NULL;
+}
+
+/**
+ * fdt_index_get() - get the index for a device tree
+ *
+ * @fdt:	Device tree to look up
+ * @return index, or NULL if the tree is not indexed
+ */
+static struct fdt_index *fdt_index_get(const void *fdt)
+{
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+	if (fdt_idx_disabled || !fdt || fdt != gd->fdt_blob)
+		return NULL;
+	if (fdt_idx && fdt_idx->fdt == fdt)
+		return fdt_idx;
+	if (fdt_idx)
+		fdt_index_free(fdt_idx);
+	fdt_idx = fdt_index_build(fdt);
+
+	return fdt_idx;
+}
+
+bool fdt_index_find_phandle(const void *fdt, uint32_t phandle, int *offsetp)
+{
+	struct fdt_index *idx = fdt_index_get(fdt);
+	int lo, hi;
+
+	if (!idx)
+		return false;
+
+	/* Find the first entry which is not below @phandle */
+	lo = 0;
+	hi = idx->phandle_count;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (idx->phandles[mid].phandle < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < idx->phandle_count && idx->phandles[lo].phandle == phandle)
+		*offsetp = idx->phandles[lo].offset;
+	else
+		*offsetp = -FDT_ERR_NOTFOUND;
+
+	return true;
+}
+
+bool fdt_index_find_compatible(const void *fdt, int startoffset,
+			       const char *compatible, int *offsetp)
+{
+	struct fdt_index_compat *compats;
+	struct fdt_index *idx;
+	int lo, hi, end;
+	uint32_t hash;
+
+	/* Let libfdt report bad offsets */
+	if (startoffset < -1)
+		return false;
+	idx = fdt_index_get(fdt);
+	if (!idx)
+		return false;
+	compats = idx->compats;
+	*offsetp = -FDT_ERR_NOTFOUND;
+
+	/* Find the first entry with this hash */
+	hash = fdt_index_hash(compatible, strlen(compatible));
+	lo = 0;
+	hi = idx->compat_count;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (compats[mid].hash < hash)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* Skip other strings with the same hash */
+	while (lo < idx->compat_count && compats[lo].hash == hash &&
+	       strcmp(compats[lo].str, compatible))
+		lo++;
+	if (lo == idx->compat_count || compats[lo].hash != hash)
+		return true;
+
+	/* Find the end of the run of nodes with this string */
+	for (end = lo + 1; end < idx->compat_count; end++) {
+		if (compats[end].hash != hash ||
+		    strcmp(compats[end].str, compatible))
+			break;
+	}
+
+	/* Find the first node in the run after @startoffset */
+	hi = end;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (compats[mid].offset <= startoffset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < end)
+		*offsetp = compats[lo].offset;
+
+	return true;
+}
+
+static struct fdt_index_path *fdt_index_path_slot(struct fdt_index *idx,
+						  const char *path,
+						  int namelen)
+{
+	uint32_t hash = fdt_index_hash(path, namelen);
+
+	return &idx->paths[hash & (FDT_INDEX_PATH_SLOTS - 1)];
+}
+
+bool fdt_index_find_path(const void *fdt, const char *path, int namelen,
+			 int *offsetp)
+{
+	struct fdt_index *idx = fdt_index_get(fdt);
+	struct fdt_index_path *slot;
+
+	if (!idx)
+		return false;
+	slot = fdt_index_path_slot(idx, path, namelen);
+	if (!slot->path || slot->len != namelen ||
+	    memcmp(slot->path, path, namelen))
+		return false;
+	*offsetp = slot->offset;
+
+	return true;
+}
+
+void fdt_index_add_path(const void *fdt, const char *path, int namelen,
+			int offset)
+{
+	struct fdt_index *idx = fdt_index_get(fdt);
+	struct fdt_index_path *slot;
+	char *copy;
+
+	if (!idx)
+		return;
+	slot = fdt_index_path_slot(idx, path, namelen);
+	if (slot->path && slot->len >= namelen) {
+		copy = slot->path;
+	} else {
+		copy = realloc(slot->path, namelen + 1);
+		if (!copy)
+			return;
+	}
+	memcpy(copy, path, namelen);
+	copy[namelen] = '\0';
+	slot->path = copy;
+	slot->len = namelen;
+	slot->offset = offset;
+}
+
+void fdt_index_invalidate(const void *fdt)
+{
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return;
+	if (fdt_idx && fdt_idx->fdt == fdt) {
+		fdt_index_free(fdt_idx);
+		fdt_idx = NULL;
+	}
+}
+
+void fdt_index_set_enabled(bool enable)
+{
+	fdt_idx_disabled = !enable;
+	if (!enable && fdt_idx) {
+		fdt_index_free(fdt_idx);
+		fdt_idx = NULL;
+	}
+}
@@ -158,14 +158,13 @@ static const char *fdt_path_next_separator(const char *path, int len)
 		return sep2;
 }
 
-int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
+static int fdt_path_offset_namelen_(const void *fdt, const char *path,
+				    int namelen)
 {
 	const char *end = path + namelen;
 	const char *p = path;
 	int offset = 0;
 
-	FDT_CHECK_HEADER(fdt);
-
 	/* see if we have an alias */
 	if (*path != '/') {
 		const char *q = fdt_path_next_separator(path, namelen);
@@ -204,6 +203,24 @@ int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
 	return offset;
 }
 
+int fdt_path_offset_namelen(const void *fdt, const char *path, int namelen)
+{
+	int offset;
+
+	FDT_CHECK_HEADER(fdt);
+
+#ifndef USE_HOSTCC
+	if (fdt_index_find_path(fdt, path, namelen, &offset))
+		return offset;
+#endif
+	offset = fdt_path_offset_namelen_(fdt, path, namelen);
+#ifndef USE_HOSTCC
+	fdt_index_add_path(fdt, path, namelen, offset);
+#endif
+
+	return offset;
+}
+
 int fdt_path_offset(const void *fdt, const char *path)
 {
 	return fdt_path_offset_namelen(fdt, path, strlen(path));
@@ -510,6 +527,11 @@ int fdt_node_offset_by_phandle(const void *fdt, uint32_t phandle)
 
 	FDT_CHECK_HEADER(fdt);
 
+#ifndef USE_HOSTCC
+	if (fdt_index_find_phandle(fdt, phandle, &offset))
+		return offset;
+#endif
+
 	/* FIXME: The algorithm here is pretty horrible: we
 	 * potentially scan each property of a node in
 	 * fdt_get_phandle(), then if that didn't find what
@@ -663,6 +685,11 @@ int fdt_node_offset_by_compatible(const void *fdt, int startoffset,
 
 	FDT_CHECK_HEADER(fdt);
 
+#ifndef USE_HOSTCC
+	if (fdt_index_find_compatible(fdt, startoffset, compatible, &offset))
+		return offset;
+#endif
+
 	/* FIXME: The algorithm here is pretty horrible: we scan each
 	 * property of a node in fdt_node_check_compatible(), then if
 	 * that didn't find what we want, we scan over them again
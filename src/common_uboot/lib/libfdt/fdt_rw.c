@@ -1,2 +1,136 @@
 #include <linux/libfdt_env.h>
+
+#if CONFIG_IS_ENABLED(OF_LIBFDT_INDEX)
+/*
+ * Build the upstream functions under other names, so that the versions
+ * below can drop the lookup index before the tree changes. The header is
+ * included before the renaming, so that it declares the public names.
+ */
+#include <linux/libfdt.h>
+
+int fdt_add_mem_rsv_noindex(void *fdt, uint64_t address, uint64_t size);
+int fdt_del_mem_rsv_noindex(void *fdt, int n);
+int fdt_set_name_noindex(void *fdt, int nodeoffset, const char *name);
+int fdt_setprop_placeholder_noindex(void *fdt, int nodeoffset,
+				    const char *name, int len,
+				    void **prop_data);
+int fdt_setprop_noindex(void *fdt, int nodeoffset, const char *name,
+			const void *val, int len);
+int fdt_appendprop_noindex(void *fdt, int nodeoffset, const char *name,
+			   const void *val, int len);
+int fdt_delprop_noindex(void *fdt, int nodeoffset, const char *name);
+int fdt_add_subnode_namelen_noindex(void *fdt, int parentoffset,
+				    const char *name, int namelen);
+int fdt_add_subnode_noindex(void *fdt, int parentoffset, const char *name);
+int fdt_del_node_noindex(void *fdt, int nodeoffset);
+int fdt_open_into_noindex(const void *fdt, void *buf, int bufsize);
+int fdt_pack_noindex(void *fdt);
+
+#define fdt_add_mem_rsv		fdt_add_mem_rsv_noindex
+#define fdt_del_mem_rsv		fdt_del_mem_rsv_noindex
+#define fdt_set_name		fdt_set_name_noindex
+#define fdt_setprop_placeholder	fdt_setprop_placeholder_noindex
+#define fdt_setprop		fdt_setprop_noindex
+#define fdt_appendprop		fdt_appendprop_noindex
+#define fdt_delprop		fdt_delprop_noindex
+#define fdt_add_subnode_namelen	fdt_add_subnode_namelen_noindex
+#define fdt_add_subnode		fdt_add_subnode_noindex
+#define fdt_del_node		fdt_del_node_noindex
+#define fdt_open_into		fdt_open_into_noindex
+#define fdt_pack		fdt_pack_noindex
+#endif
+
 #include "../../scripts/dtc/libfdt/fdt_rw.c"
+
+#if CONFIG_IS_ENABLED(OF_LIBFDT_INDEX)
+#undef fdt_add_mem_rsv
+#undef fdt_del_mem_rsv
+#undef fdt_set_name
+#undef fdt_setprop_placeholder
+#undef fdt_setprop
+#undef fdt_appendprop
+#undef fdt_delprop
+#undef fdt_add_subnode_namelen
+#undef fdt_add_subnode
+#undef fdt_del_node
+#undef fdt_open_into
+#undef fdt_pack
+
+int fdt_add_mem_rsv(void *fdt, uint64_t address, uint64_t size)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_add_mem_rsv_noindex(fdt, address, size);
+}
+
+int fdt_del_mem_rsv(void *fdt, int n)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_del_mem_rsv_noindex(fdt, n);
+}
+
+int fdt_set_name(void *fdt, int nodeoffset, const char *name)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_set_name_noindex(fdt, nodeoffset, name);
+}
+
+int fdt_setprop_placeholder(void *fdt, int nodeoffset, const char *name,
+			    int len, void **prop_data)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_setprop_placeholder_noindex(fdt, nodeoffset, name, len,
+					       prop_data);
+}
+
+int fdt_setprop(void *fdt, int nodeoffset, const char *name,
+		const void *val, int len)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_setprop_noindex(fdt, nodeoffset, name, val, len);
+}
+
+int fdt_appendprop(void *fdt, int nodeoffset, const char *name,
+		   const void *val, int len)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_appendprop_noindex(fdt, nodeoffset, name, val, len);
+}
+
+int fdt_delprop(void *fdt, int nodeoffset, const char *name)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_delprop_noindex(fdt, nodeoffset, name);
+}
+
+int fdt_add_subnode_namelen(void *fdt, int parentoffset,
+			    const char *name, int namelen)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_add_subnode_namelen_noindex(fdt, parentoffset, name,
+					       namelen);
+}
+
+int fdt_add_subnode(void *fdt, int parentoffset, const char *name)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_add_subnode_noindex(fdt, parentoffset, name);
+}
+
+int fdt_del_node(void *fdt, int nodeoffset)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_del_node_noindex(fdt, nodeoffset);
+}
+
+int fdt_open_into(const void *fdt, void *buf, int bufsize)
+{
+	fdt_index_invalidate(buf);
+	return fdt_open_into_noindex(fdt, buf, bufsize);
+}
+
+int fdt_pack(void *fdt)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_pack_noindex(fdt);
+}
+#endif
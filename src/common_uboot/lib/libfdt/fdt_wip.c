@@ -1,2 +1,60 @@
 #include <linux/libfdt_env.h>
+
+#if CONFIG_IS_ENABLED(OF_LIBFDT_INDEX)
+/* See fdt_rw.c: the versions below drop the lookup index first */
+#include <linux/libfdt.h>
+
+int fdt_setprop_inplace_namelen_partial_noindex(void *fdt, int nodeoffset,
+						const char *name, int namelen,
+						uint32_t idx, const void *val,
+						int len);
+int fdt_setprop_inplace_noindex(void *fdt, int nodeoffset, const char *name,
+				const void *val, int len);
+int fdt_nop_property_noindex(void *fdt, int nodeoffset, const char *name);
+int fdt_nop_node_noindex(void *fdt, int nodeoffset);
+
+#define fdt_setprop_inplace_namelen_partial \
+	fdt_setprop_inplace_namelen_partial_noindex
+#define fdt_setprop_inplace	fdt_setprop_inplace_noindex
+#define fdt_nop_property	fdt_nop_property_noindex
+#define fdt_nop_node		fdt_nop_node_noindex
+#endif
+
 #include "../../scripts/dtc/libfdt/fdt_wip.c"
+
+#if CONFIG_IS_ENABLED(OF_LIBFDT_INDEX)
+#undef fdt_setprop_inplace_namelen_partial
+#undef fdt_setprop_inplace
+#undef fdt_nop_property
+#undef fdt_nop_node
+
+int fdt_setprop_inplace_namelen_partial(void *fdt, int nodeoffset,
+					const char *name, int namelen,
+					uint32_t idx, const void *val,
+					int len)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_setprop_inplace_namelen_partial_noindex(fdt, nodeoffset,
+							   name, namelen, idx,
+							   val, len);
+}
+
+int fdt_setprop_inplace(void *fdt, int nodeoffset, const char *name,
+			const void *val, int len)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_setprop_inplace_noindex(fdt, nodeoffset, name, val, len);
+}
+
+int fdt_nop_property(void *fdt, int nodeoffset, const char *name)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_nop_property_noindex(fdt, nodeoffset, name);
+}
+
+int fdt_nop_node(void *fdt, int nodeoffset)
+{
+	fdt_index_invalidate(fdt);
+	return fdt_nop_node_noindex(fdt, nodeoffset);
+}
+#endif
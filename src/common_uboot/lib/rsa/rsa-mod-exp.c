@@ -67,6 +67,61 @@ static int greater_equal_modulus(const struct rsa_public_key *key,
 	return 1;  /* equal */
 }
 
+#if defined(CONFIG_RSA_SOFTWARE_EXP_UMAAL) && !defined(USE_HOSTCC)
+/*
+ * UMAAL computes hi:lo = a * b + lo + hi, which cannot overflow. That is one
+ * column of the multiply-add below, including both carries, in a single
+ * instruction.
+ */
+static inline void umaal(uint32_t *lo, uint32_t *hi, uint32_t a, uint32_t b)
+{
+	asm ("umaal %0, %1, %2, %3"
+	     : "+r" (*lo), "+r" (*hi)
+	     : "r" (a), "r" (b));
+}
+
+/**
+ * montgomery_mul_add_step() - Perform montgomery multiply-add step
+ *
+ * Operation: montgomery result[] += a * b[] / n0inv % modulus
+ *
+ * This keeps the two running carries in 32-bit registers and lets UMAAL do
+ * the 64-bit sums, which the portable version has to do with 64-bit
+ * additions.
+ *
+ * @key:	RSA key
+ * @result:	Place to put result, as little endian word array
+ * @a:		Multiplier
+ * @b:		Multiplicand, as little endian word array
+ */
+static void montgomery_mul_add_step(const struct rsa_public_key *key,
+		uint32_t result[], const uint32_t a, const uint32_t b[])
+{
+	const uint32_t *modulus = key->modulus;
+	uint32_t carry_a = 0, carry_b = 0;
+	uint32_t acc_a, acc_b, d0, top;
+	uint i;
+
+	acc_a = result[0];
+	umaal(&acc_a, &carry_a, a, b[0]);
+	d0 = acc_a * key->n0inv;
+	acc_b = acc_a;
+	umaal(&acc_b, &carry_b, d0, modulus[0]);
+	for (i = 1; i < key->len; i++) {
+		acc_a = result[i];
+		umaal(&acc_a, &carry_a, a, b[i]);
+		acc_b = acc_a;
+		umaal(&acc_b, &carry_b, d0, modulus[i]);
+		result[i - 1] = acc_b;
+	}
+
+	top = carry_a + carry_b;
+	result[i - 1] = top;
+
+	if (top < carry_a)
+		subtract_modulus(key, result);
+}
+#else
 /**
  * montgomery_mul_add_step() - Perform montgomery multiply-add step
  *
@@ -101,6 +156,7 @@ static void montgomery_mul_add_step(const struct rsa_public_key *key,
 	if (acc_a >> 32)
 		subtract_modulus(key, result);
 }
+#endif
 
 /**
  * montgomery_mul() - Perform montgomery mutitply
@@ -541,16 +541,28 @@ void * memcpy(void *dest, const void *src, size_t count)
  */
 void * memmove(void * dest,const void *src,size_t count)
 {
+	unsigned long *dl, *sl;
 	char *tmp, *s;
 
-	if (dest <= src) {
+	if (dest <= src || dest >= src + count) {
 		memcpy(dest, src, count);
 	} else {
 		tmp = (char *) dest + count;
 		s = (char *) src + count;
+		/* copy downwards, a word at a time if the ends are aligned */
+		if ((((ulong)tmp | (ulong)s) & (sizeof(*dl) - 1)) == 0) {
+			dl = (unsigned long *)tmp;
+			sl = (unsigned long *)s;
+			while (count >= sizeof(*dl)) {
+				*--dl = *--sl;
+				count -= sizeof(*dl);
+			}
+			tmp = (char *)dl;
+			s = (char *)sl;
+		}
 		while (count--)
 			*--tmp = *--s;
-		}
+	}
 
 	return dest;
 }
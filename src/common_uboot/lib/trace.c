@@ -4,6 +4,7 @@
  */
 
 #include <common.h>
+#include <errno.h>
 #include <mapmem.h>
 #include <trace.h>
 #include <asm/io.h>
@@ -14,6 +15,9 @@ DECLARE_GLOBAL_DATA_PTR;
 static char trace_enabled __attribute__((section(".data")));
 static char trace_inited __attribute__((section(".data")));
 
+/* Number of functions on the call stack which sampling can report */
+#define TRACE_STACK_DEPTH	64
+
 /* The header block at the start of the trace memory area */
 struct trace_hdr {
 	int func_count;		/* Total number of function call sites */
@@ -27,18 +31,52 @@ struct trace_hdr {
 	 */
 	uintptr_t *call_accum;
 
+	/*
+	 * Bitmap of the functions whose calls are recorded, indexed in the
+	 * same way. Calls to the other functions are still counted.
+	 */
+	ulong *func_traced;
+
 	/* Function trace list */
 	struct trace_call *ftrace;	/* The function call records */
 	ulong ftrace_size;	/* Num. of ftrace records we have space for */
 	ulong ftrace_count;	/* Num. of ftrace records written */
 	ulong ftrace_too_deep_count;	/* Functions that were too deep */
+	ulong ftrace_filtered_count;	/* Functions left out by the filter */
+
+	/*
+	 * Sampling: rather than recording every call, record the call stack
+	 * at most once every sample_us microseconds
+	 */
+	ulong sample_us;	/* Sampling period, 0 to record every call */
+	ulong last_sample;	/* Timestamp of the last sample */
+	ulong sample_count;	/* Number of samples taken */
+	uint32_t stack[TRACE_STACK_DEPTH];	/* Functions on the call stack */
 
 	int depth;
 	int depth_limit;
 	int max_depth;
 };
 
-static struct trace_hdr *hdr;	/* Pointer to start of trace buffer */
+/*
+ * Pointer to start of trace buffer. This is set up before relocation when
+ * CONFIG_TRACE_EARLY is enabled, so it must not be in BSS.
+ */
+static struct trace_hdr *hdr __attribute__((section(".data")));
+
+/*
+ * Get the timestamp for a trace record, in microseconds. When the system
+ * timer counts microseconds this reads it directly, avoiding the 64-bit
+ * arithmetic in timer_get_us() on every function entry and exit.
+ */
+static inline ulong __attribute__((no_instrument_function)) trace_get_us(void)
+{
+#if defined(CONFIG_SYS_TIMER_COUNTER) && CONFIG_SYS_TIMER_RATE == 1000000
+	return timer_read_counter();
+#else
+	return timer_get_us();
+#endif
+}
 
 static inline uintptr_t __attribute__((no_instrument_function))
 		func_ptr_to_num(void *func_ptr)
@@ -56,19 +94,34 @@ static inline uintptr_t __attribute__((no_instrument_function))
 	return offset / FUNC_SITE_SIZE;
 }
 
-static void __attribute__((no_instrument_function)) add_ftrace(void *func_ptr,
+/* Check whether calls to a function are recorded */
+static inline bool __attribute__((no_instrument_function))
+		func_is_traced(uintptr_t func)
+{
+	if (func >= hdr->func_count)
+		return true;
+
+	return hdr->func_traced[func / BITS_PER_LONG] &
+		(1UL << (func % BITS_PER_LONG));
+}
+
+static void __attribute__((no_instrument_function)) add_ftrace(uintptr_t func,
 				void *caller, ulong flags)
 {
 	if (hdr->depth > hdr->depth_limit) {
 		hdr->ftrace_too_deep_count++;
 		return;
 	}
+	if (!func_is_traced(func)) {
+		hdr->ftrace_filtered_count++;
+		return;
+	}
 	if (hdr->ftrace_count < hdr->ftrace_size) {
 		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
 
-		rec->func = func_ptr_to_num(func_ptr);
+		rec->func = func;
 		rec->caller = func_ptr_to_num(caller);
-		rec->flags = flags | (timer_get_us() & FUNCF_TIMESTAMP_MASK);
+		rec->flags = flags | (trace_get_us() & FUNCF_TIMESTAMP_MASK);
 	}
 	hdr->ftrace_count++;
 }
@@ -85,6 +138,43 @@ static void __attribute__((no_instrument_function)) add_textbase(void)
 	hdr->ftrace_count++;
 }
 
+/**
+ * Record the call stack, if the sampling period has passed
+ *
+ * The stack is written as one FUNCF_SAMPLE record for each function,
+ * outermost first, with the position in the stack in the caller field.
+ * Functions which are left out by the filter or are beyond the depth limit
+ * are not included.
+ */
+static void __attribute__((no_instrument_function)) add_sample(void)
+{
+	ulong now = trace_get_us();
+	int depth, i, upto;
+
+	if (now - hdr->last_sample < hdr->sample_us)
+		return;
+	hdr->last_sample = now;
+	hdr->sample_count++;
+
+	depth = min(hdr->depth, min(hdr->depth_limit + 1, TRACE_STACK_DEPTH));
+	for (i = upto = 0; i < depth; i++) {
+		uint32_t func = hdr->stack[i];
+
+		if (!func_is_traced(func))
+			continue;
+		if (hdr->ftrace_count < hdr->ftrace_size) {
+			struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
+
+			rec->func = func;
+			rec->caller = upto;
+			rec->flags = FUNCF_SAMPLE |
+				(now & FUNCF_TIMESTAMP_MASK);
+		}
+		hdr->ftrace_count++;
+		upto++;
+	}
+}
+
 /**
  * This is called on every function entry
  *
@@ -98,26 +188,31 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_enter(
 		void *func_ptr, void *caller)
 {
 	if (trace_enabled) {
-		int func;
+		uintptr_t func = func_ptr_to_num(func_ptr);
 
-		add_ftrace(func_ptr, caller, FUNCF_ENTRY);
-		func = func_ptr_to_num(func_ptr);
 		if (func < hdr->func_count) {
 			hdr->call_accum[func]++;
 			hdr->call_count++;
 		} else {
 			hdr->untracked_count++;
 		}
+		if (!hdr->sample_us)
+			add_ftrace(func, caller, FUNCF_ENTRY);
+		if ((uint)hdr->depth < TRACE_STACK_DEPTH)
+			hdr->stack[hdr->depth] = func;
 		hdr->depth++;
-		if (hdr->depth > hdr->depth_limit)
+		if (hdr->depth > hdr->max_depth)
 			hdr->max_depth = hdr->depth;
+		if (hdr->sample_us)
+			add_sample();
 	}
 }
 
 /**
  * This is called on every function exit
  *
- * We do nothing here.
+ * We record the exit at the same depth as the entry, so that the limit on
+ * the call depth applies to both.
  *
  * @param func_ptr	Pointer to function being entered
  * @param caller	Pointer to function which called this function
@@ -126,8 +221,12 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_exit(
 		void *func_ptr, void *caller)
 {
 	if (trace_enabled) {
-		add_ftrace(func_ptr, caller, FUNCF_EXIT);
 		hdr->depth--;
+		if (hdr->sample_us)
+			add_sample();
+		else
+			add_ftrace(func_ptr_to_num(func_ptr), caller,
+				   FUNCF_EXIT);
 	}
 }
 
@@ -141,7 +240,8 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_exit(
  * @param buff_size	Size of buffer
  * @param needed	Returns size of buffer needed, which may be
  *			greater than buff_size if we ran out of space.
- * @return 0 if ok, -1 if space was exhausted
+ * @return 0 if ok, -1 if space was exhausted, -ENOENT if there is no trace
+ * data
  */
 int trace_list_functions(void *buff, int buff_size, unsigned int *needed)
 {
@@ -150,6 +250,9 @@ int trace_list_functions(void *buff, int buff_size, unsigned int *needed)
 	int func;
 	int upto;
 
+	if (!hdr)
+		return -ENOENT;
+
 	end = buff ? buff + buff_size : NULL;
 
 	/* Place some header information */
@@ -194,6 +297,9 @@ int trace_list_calls(void *buff, int buff_size, unsigned *needed)
 	int rec, upto;
 	int count;
 
+	if (!hdr)
+		return -ENOENT;
+
 	end = buff ? buff + buff_size : NULL;
 
 	/* Place some header information */
@@ -211,7 +317,11 @@ int trace_list_calls(void *buff, int buff_size, unsigned *needed)
 			struct trace_call *out = ptr;
 
 			out->func = call->func * FUNC_SITE_SIZE;
-			out->caller = call->caller * FUNC_SITE_SIZE;
+			/* For samples, this is the position in the stack */
+			if (TRACE_CALL_TYPE(call) == FUNCF_SAMPLE)
+				out->caller = call->caller;
+			else
+				out->caller = call->caller * FUNC_SITE_SIZE;
 			out->flags = call->flags;
 			upto++;
 		}
@@ -262,11 +372,141 @@ void trace_print_stats(void)
 	printf("%15d call depth limit\n", hdr->depth_limit);
 	print_grouped_ull(hdr->ftrace_too_deep_count, 10);
 	puts(" calls not traced due to depth\n");
+	print_grouped_ull(hdr->ftrace_filtered_count, 10);
+	puts(" calls not traced due to filter\n");
+	if (hdr->sample_us) {
+		printf("%15lu us sampling period\n", hdr->sample_us);
+		print_grouped_ull(hdr->sample_count, 10);
+		puts(" samples\n");
+	}
+}
+
+int trace_set_depth_limit(int limit)
+{
+	if (!trace_inited)
+		return -ENOENT;
+	hdr->depth_limit = limit;
+
+	return 0;
+}
+
+int trace_set_sample_us(ulong period_us)
+{
+	if (!trace_inited)
+		return -ENOENT;
+	hdr->last_sample = trace_get_us();
+	hdr->sample_us = period_us;
+
+	return 0;
+}
+
+int trace_set_filter(ulong addr, int traced)
+{
+	ulong func, mask;
+
+	if (!trace_inited)
+		return -ENOENT;
+#ifdef CONFIG_SANDBOX
+	func = (addr - (uintptr_t)&_init) / FUNC_SITE_SIZE;
+#else
+	func = (addr - CONFIG_SYS_TEXT_BASE) / FUNC_SITE_SIZE;
+#endif
+	if (func >= hdr->func_count)
+		return -EINVAL;
+	mask = 1UL << (func % BITS_PER_LONG);
+	if (traced)
+		hdr->func_traced[func / BITS_PER_LONG] |= mask;
+	else
+		hdr->func_traced[func / BITS_PER_LONG] &= ~mask;
+
+	return 0;
+}
+
+int trace_set_filter_all(int traced)
+{
+	if (!trace_inited)
+		return -ENOENT;
+	memset(hdr->func_traced, traced ? 0xff : 0,
+	       BITS_TO_LONGS(hdr->func_count) * sizeof(ulong));
+
+	return 0;
 }
 
 void __attribute__((no_instrument_function)) trace_set_enabled(int enabled)
 {
-	trace_enabled = enabled != 0;
+	/* There is nowhere to record anything if trace_init() failed */
+	trace_enabled = enabled != 0 && hdr;
+}
+
+/* Work out the space needed for the header, call counts and filter */
+static size_t __attribute__((no_instrument_function))
+		trace_space_needed(ulong func_count)
+{
+	return sizeof(*hdr) + func_count * sizeof(uintptr_t) +
+		BITS_TO_LONGS(func_count) * sizeof(ulong);
+}
+
+/**
+ * Set up the trace buffer, and clear it if requested
+ *
+ * The header is followed by the call counts, the filter bitmap and then the
+ * call records, which use the rest of the buffer.
+ *
+ * @param buff		Pointer to trace buffer
+ * @param buff_size	Size of trace buffer
+ * @param func_count	Number of function sites
+ * @param clear		true to clear the counts and trace every function
+ */
+static void __attribute__((no_instrument_function)) trace_setup(void *buff,
+		size_t buff_size, ulong func_count, bool clear)
+{
+	size_t needed = trace_space_needed(func_count);
+
+	hdr = buff;
+	if (clear)
+		memset(hdr, '\0', needed);
+	hdr->func_count = func_count;
+	hdr->call_accum = (uintptr_t *)(hdr + 1);
+	hdr->func_traced = (ulong *)(hdr->call_accum + func_count);
+	if (clear)
+		memset(hdr->func_traced, 0xff,
+		       BITS_TO_LONGS(func_count) * sizeof(ulong));
+
+	/* Use any remaining space for the timed function trace */
+	hdr->ftrace = (struct trace_call *)((char *)buff + needed);
+	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+}
+
+/**
+ * Check that a trace buffer at a fixed address is in DRAM
+ *
+ * The address is chosen when U-Boot is built, so it may be in a DRAM bank
+ * which is not fitted, e.g. the second bank of vexpress under QEMU without
+ * '-m 1G'.
+ *
+ * @param addr		Address of the buffer
+ * @param size		Size of the buffer
+ * @return true if the buffer lies within one of the board's DRAM banks
+ */
+static bool __attribute__((no_instrument_function)) trace_in_dram(ulong addr,
+		ulong size)
+{
+#ifdef CONFIG_NR_DRAM_BANKS
+	int i;
+
+	for (i = 0; i < CONFIG_NR_DRAM_BANKS; i++) {
+		phys_addr_t start = gd->bd->bi_dram[i].start;
+		phys_size_t bank_size = gd->bd->bi_dram[i].size;
+
+		if (addr >= start && addr - start <= bank_size &&
+		    size <= bank_size - (addr - start))
+			return true;
+	}
+
+	return false;
+#else
+	return true;
+#endif
 }
 
 /**
@@ -282,6 +522,14 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 	size_t needed;
 	int was_disabled = !trace_enabled;
 
+	if (CONFIG_TRACE_BUFFER_ADDR &&
+	    !trace_in_dram(map_to_sysmem(buff), buff_size)) {
+		printf("trace: no memory for buffer at %08lx, not tracing\n",
+		       (ulong)map_to_sysmem(buff));
+		trace_enabled = 0;
+		hdr = NULL;
+		return -ENOMEM;
+	}
 	if (!was_disabled) {
 #ifdef CONFIG_TRACE_EARLY
 		char *end;
@@ -292,39 +540,39 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 		 * tracing while we are doing this.
 		 */
 		trace_enabled = 0;
-		hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR,
-				 CONFIG_TRACE_EARLY_SIZE);
-		end = (char *)&hdr->ftrace[hdr->ftrace_count];
-		used = end - (char *)hdr;
-		printf("trace: copying %08lx bytes of early data from %x to %08lx\n",
-		       used, CONFIG_TRACE_EARLY_ADDR,
-		       (ulong)map_to_sysmem(buff));
-		memcpy(buff, hdr, used);
+		if (trace_in_dram(CONFIG_TRACE_EARLY_ADDR,
+				  CONFIG_TRACE_EARLY_SIZE)) {
+			hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR,
+					 CONFIG_TRACE_EARLY_SIZE);
+			end = (char *)&hdr->ftrace[hdr->ftrace_count];
+			used = end - (char *)hdr;
+			printf("trace: copying %08lx bytes of early data from %x to %08lx\n",
+			       used, CONFIG_TRACE_EARLY_ADDR,
+			       (ulong)map_to_sysmem(buff));
+			memcpy(buff, hdr, used);
+		} else {
+			printf("trace: no memory at %08x, early data lost\n",
+			       CONFIG_TRACE_EARLY_ADDR);
+			was_disabled = 1;
+		}
 #else
 		puts("trace: already enabled\n");
 		return -1;
 #endif
 	}
-	hdr = (struct trace_hdr *)buff;
-	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t);
+	needed = trace_space_needed(func_count);
 	if (needed > buff_size) {
 		printf("trace: buffer size %zd bytes: at least %zd needed\n",
 		       buff_size, needed);
 		return -1;
 	}
 
-	if (was_disabled)
-		memset(hdr, '\0', needed);
-	hdr->func_count = func_count;
-	hdr->call_accum = (uintptr_t *)(hdr + 1);
-
-	/* Use any remaining space for the timed function trace */
-	hdr->ftrace = (struct trace_call *)(buff + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+	trace_setup(buff, buff_size, func_count, was_disabled);
 	add_textbase();
 
 	puts("trace: enabled\n");
 	hdr->depth_limit = 15;
+	hdr->sample_us = CONFIG_TRACE_SAMPLE_US;
 	trace_enabled = 1;
 	trace_inited = 1;
 	return 0;
@@ -341,23 +589,18 @@ int __attribute__((no_instrument_function)) trace_early_init(void)
 	if (trace_enabled)
 		return 0;
 
-	hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR, CONFIG_TRACE_EARLY_SIZE);
-	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t);
+	needed = trace_space_needed(func_count);
 	if (needed > buff_size) {
 		printf("trace: buffer size is %zd bytes, at least %zd needed\n",
 		       buff_size, needed);
 		return -1;
 	}
 
-	memset(hdr, '\0', needed);
-	hdr->call_accum = (uintptr_t *)(hdr + 1);
-	hdr->func_count = func_count;
-
-	/* Use any remaining space for the timed function trace */
-	hdr->ftrace = (struct trace_call *)((char *)hdr + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+	trace_setup(map_sysmem(CONFIG_TRACE_EARLY_ADDR, buff_size), buff_size,
+		    func_count, true);
 	add_textbase();
 	hdr->depth_limit = 200;
+	hdr->sample_us = CONFIG_TRACE_SAMPLE_US;
 	printf("trace: early enable at %08x\n", CONFIG_TRACE_EARLY_ADDR);
 
 	trace_enabled = 1;
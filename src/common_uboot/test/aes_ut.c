@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test and benchmark for AES-128
+ *
+ * Checks single blocks against the example in FIPS-197 appendix C.1 and
+ * CBC mode against the example in NIST SP 800-38A F.2.1/F.2.2, then
+ * encrypts and decrypts a buffer in place with CBC and reports the speed
+ * of each, in MiB/s.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <errno.h>
+#include <malloc.h>
+#include <uboot_aes.h>
+#include <linux/sizes.h>
+#include <test/suites.h>
+
+/* Size of the buffer used for timing, and how much is processed in all */
+#define AES_UT_BUF_SIZE		SZ_64K
+#define AES_UT_TOTAL_BYTES	SZ_4M
+
+static const u8 fips197_key[AES_KEY_LENGTH] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static const u8 fips197_plain[AES_KEY_LENGTH] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+static const u8 fips197_cipher[AES_KEY_LENGTH] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+
+static const u8 sp800_key[AES_KEY_LENGTH] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static const u8 sp800_iv[AES_KEY_LENGTH] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static const u8 sp800_plain[4 * AES_KEY_LENGTH] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+	0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+	0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+
+static const u8 sp800_cipher[4 * AES_KEY_LENGTH] = {
+	0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46,
+	0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+	0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee,
+	0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b,
+	0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+	0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09,
+	0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7,
+};
+
+static int aes_ut_check(const char *name, const u8 *out, const u8 *expect,
+			int len)
+{
+	if (!memcmp(out, expect, len))
+		return 0;
+	printf("%s: output does not match\n", name);
+	print_buffer(0, out, 1, len, 16);
+
+	return -EINVAL;
+}
+
+static int test_vectors(void)
+{
+	u8 key_exp[AES_EXPAND_KEY_LENGTH];
+	u8 buf[sizeof(sp800_plain)];
+	int ret = 0;
+
+	aes_expand_key((u8 *)fips197_key, key_exp);
+	aes_encrypt((u8 *)fips197_plain, key_exp, buf);
+	ret |= aes_ut_check("encrypt", buf, fips197_cipher, AES_KEY_LENGTH);
+	aes_decrypt((u8 *)fips197_cipher, key_exp, buf);
+	ret |= aes_ut_check("decrypt", buf, fips197_plain, AES_KEY_LENGTH);
+
+	aes_expand_key((u8 *)sp800_key, key_exp);
+	aes_cbc_encrypt_blocks(key_exp, (u8 *)sp800_iv, (u8 *)sp800_plain, buf,
+			       4);
+	ret |= aes_ut_check("cbc encrypt", buf, sp800_cipher, sizeof(buf));
+	aes_cbc_decrypt_blocks(key_exp, (u8 *)sp800_iv, (u8 *)sp800_cipher,
+			       buf, 4);
+	ret |= aes_ut_check("cbc decrypt", buf, sp800_plain, sizeof(buf));
+
+	/* Decrypting in place is what 'aes dec' does with src == dst */
+	aes_cbc_decrypt_blocks(key_exp, (u8 *)sp800_iv, buf, buf, 4);
+	aes_cbc_encrypt_blocks(key_exp, (u8 *)sp800_iv, buf, buf, 4);
+	ret |= aes_ut_check("cbc in place", buf, sp800_plain, sizeof(buf));
+
+	return ret;
+}
+
+static ulong aes_ut_mibps(ulong us)
+{
+	if (!us)
+		us = 1;
+
+	return lldiv((u64)AES_UT_TOTAL_BYTES * 1000000, us) >> 20;
+}
+
+static int test_speed(void)
+{
+	u8 key_exp[AES_EXPAND_KEY_LENGTH];
+	u32 blocks = AES_UT_BUF_SIZE / AES_KEY_LENGTH;
+	ulong start, enc_us, dec_us;
+	u8 *buf, *copy;
+	int i, ret;
+
+	buf = malloc(AES_UT_BUF_SIZE);
+	copy = malloc(AES_UT_BUF_SIZE);
+	if (!buf || !copy) {
+		printf("Out of memory\n");
+		ret = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < AES_UT_BUF_SIZE; i++)
+		buf[i] = i * 7;
+	memcpy(copy, buf, AES_UT_BUF_SIZE);
+	aes_expand_key((u8 *)sp800_key, key_exp);
+
+	start = timer_get_us();
+	for (i = 0; i < AES_UT_TOTAL_BYTES / AES_UT_BUF_SIZE; i++)
+		aes_cbc_encrypt_blocks(key_exp, (u8 *)sp800_iv, buf, buf,
+				       blocks);
+	enc_us = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (i = 0; i < AES_UT_TOTAL_BYTES / AES_UT_BUF_SIZE; i++)
+		aes_cbc_decrypt_blocks(key_exp, (u8 *)sp800_iv, buf, buf,
+				       blocks);
+	dec_us = timer_get_us() - start;
+
+	printf("CBC encrypt: %lu MiB/s, CBC decrypt: %lu MiB/s\n",
+	       aes_ut_mibps(enc_us), aes_ut_mibps(dec_us));
+
+	/* Each decryption undoes the matching encryption */
+	ret = memcmp(buf, copy, AES_UT_BUF_SIZE) ? -EINVAL : 0;
+	if (ret)
+		printf("speed: data changed after encrypt and decrypt\n");
+out:
+	free(copy);
+	free(buf);
+
+	return ret;
+}
+
+int do_ut_aes(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	int ret;
+
+	ret = test_vectors();
+	if (!ret)
+		ret = test_speed();
+
+	printf("Test %s\n", ret ? "failed" : "passed");
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
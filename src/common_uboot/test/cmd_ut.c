@@ -46,6 +46,16 @@ static cmd_tbl_t cmd_ut_sub[] = {
 #ifdef CONFIG_UT_OVERLAY
 	U_BOOT_CMD_MKENT(overlay, CONFIG_SYS_MAXARGS, 1, do_ut_overlay, "", ""),
 #endif
+#ifdef CONFIG_UT_AES
+	U_BOOT_CMD_MKENT(aes, CONFIG_SYS_MAXARGS, 1, do_ut_aes, "", ""),
+#endif
+#ifdef CONFIG_UT_FDT_INDEX
+	U_BOOT_CMD_MKENT(fdt_index, CONFIG_SYS_MAXARGS, 1, do_ut_fdt_index,
+			 "", ""),
+#endif
+#ifdef CONFIG_UT_RSA
+	U_BOOT_CMD_MKENT(rsa, CONFIG_SYS_MAXARGS, 1, do_ut_rsa, "", ""),
+#endif
 #ifdef CONFIG_UT_TIME
 	U_BOOT_CMD_MKENT(time, CONFIG_SYS_MAXARGS, 1, do_ut_time, "", ""),
 #endif
@@ -102,6 +112,15 @@ static char ut_help_text[] =
 #ifdef CONFIG_UT_OVERLAY
 	"ut overlay [test-name]\n"
 #endif
+#ifdef CONFIG_UT_AES
+	"ut aes - Check and time AES-128\n"
+#endif
+#ifdef CONFIG_UT_FDT_INDEX
+	"ut fdt_index - Compare indexed and linear device tree lookups\n"
+#endif
+#ifdef CONFIG_UT_RSA
+	"ut rsa - Check and time RSA signature checks\n"
+#endif
 #ifdef CONFIG_UT_TIME
 	"ut time - Very basic test of time functions\n"
 #endif
@@ -462,6 +462,24 @@ static int dm_test_fdt_translation(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_fdt_translation, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+/* Test that a device under a simple-bus is found through its own uclass */
+static int dm_test_fdt_simple_bus_child(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	/*
+	 * With CONFIG_DM_LAZY_BIND the bus must not be deferred, since a
+	 * lookup in UCLASS_TEST_DUMMY would never bind it
+	 */
+	ut_assertok(uclass_get_device_by_name(UCLASS_TEST_DUMMY, "dev@1,100",
+					      &dev));
+	ut_asserteq(UCLASS_SIMPLE_BUS, device_get_uclass_id(dev->parent));
+	ut_asserteq(0x9000, dev_read_addr(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_simple_bus_child, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 /* Test devfdt_remap_addr_index() */
 static int dm_test_fdt_remap_addr_flat(struct unit_test_state *uts)
 {
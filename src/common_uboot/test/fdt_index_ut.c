@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the device tree lookup index
+ *
+ * Each test looks up everything in the control device tree, once with a
+ * linear search and once through the index, checks that the results match
+ * and reports how long each took. A last test changes a copy of the tree
+ * and checks that the index does not return stale results.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <errno.h>
+#include <malloc.h>
+#include <linux/libfdt.h>
+#include <test/suites.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Maximum number of nodes which are checked */
+#define MAX_NODES	4096
+
+/* Node which the invalidation test adds to its copy of the tree */
+#define TEST_NODE	"fdt-index-test"
+#define TEST_PATH	"/" TEST_NODE
+#define TEST_COMPAT	"u-boot,fdt-index-test"
+
+static int results[2][MAX_NODES];
+
+typedef int (*lookup_fn)(const void *fdt, int *results, int count);
+
+/* Look up the phandle of every node */
+static int lookup_phandles(const void *fdt, int *res, int count)
+{
+	int offset, i = 0;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0 && i < count;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		uint32_t phandle = fdt_get_phandle(fdt, offset);
+
+		if (phandle)
+			res[i++] = fdt_node_offset_by_phandle(fdt, phandle);
+	}
+
+	return i;
+}
+
+/* Find all nodes compatible with the first string of every node */
+static int lookup_compatibles(const void *fdt, int *res, int count)
+{
+	int offset, i = 0;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0 && i < count;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		const char *compat = fdt_getprop(fdt, offset, "compatible",
+						 NULL);
+		int node = -1;
+
+		if (!compat)
+			continue;
+		do {
+			node = fdt_node_offset_by_compatible(fdt, node, compat);
+			res[i++] = node;
+		} while (node >= 0 && i < count);
+	}
+
+	return i;
+}
+
+/* Look up the full path of every node, twice */
+static int lookup_paths(const void *fdt, int *res, int count)
+{
+	char path[256];
+	int offset, i = 0;
+
+	for (offset = fdt_next_node(fdt, -1, NULL);
+	     offset >= 0 && i + 1 < count;
+	     offset = fdt_next_node(fdt, offset, NULL)) {
+		if (fdt_get_path(fdt, offset, path, sizeof(path)))
+			continue;
+		res[i++] = fdt_path_offset(fdt, path);
+		res[i++] = fdt_path_offset(fdt, path);
+	}
+
+	return i;
+}
+
+static int run_test(const char *name, lookup_fn func)
+{
+	const void *fdt = gd->fdt_blob;
+	ulong linear_us, index_us, start;
+	int count[2];
+	int i;
+
+	fdt_index_set_enabled(false);
+	start = timer_get_us();
+	count[0] = func(fdt, results[0], MAX_NODES);
+	linear_us = timer_get_us() - start;
+
+	/* The first indexed lookup includes building the index */
+	fdt_index_set_enabled(true);
+	start = timer_get_us();
+	count[1] = func(fdt, results[1], MAX_NODES);
+	index_us = timer_get_us() - start;
+
+	printf("%-12s %6d lookups: linear %8lu us, indexed %8lu us\n", name,
+	       count[0], linear_us, index_us);
+	if (count[0] != count[1]) {
+		printf("%s: expected %d results, got %d\n", name, count[0],
+		       count[1]);
+		return -EINVAL;
+	}
+	for (i = 0; i < count[0]; i++) {
+		if (results[0][i] != results[1][i]) {
+			printf("%s: lookup %d: expected %d, got %d\n", name, i,
+			       results[0][i], results[1][i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * check_change() - check lookups of the test node after a change
+ *
+ * The lookups are done through the index first, then with a linear search,
+ * and must match. They are then done again, so that the index is built and
+ * the path is cached for the next change to invalidate.
+ *
+ * @fdt:	Device tree which was changed
+ * @what:	Name of the change, for messages
+ * @phandle:	Phandle of the test node
+ * @return 0 if OK, -EINVAL if the index gave a stale result
+ */
+static int check_change(const void *fdt, const char *what, uint32_t phandle)
+{
+	int indexed[3], linear[3];
+	int i;
+
+	indexed[0] = fdt_node_offset_by_phandle(fdt, phandle);
+	indexed[1] = fdt_node_offset_by_compatible(fdt, -1, TEST_COMPAT);
+	indexed[2] = fdt_path_offset(fdt, TEST_PATH);
+
+	fdt_index_set_enabled(false);
+	linear[0] = fdt_node_offset_by_phandle(fdt, phandle);
+	linear[1] = fdt_node_offset_by_compatible(fdt, -1, TEST_COMPAT);
+	linear[2] = fdt_path_offset(fdt, TEST_PATH);
+	fdt_index_set_enabled(true);
+
+	for (i = 0; i < ARRAY_SIZE(linear); i++) {
+		if (indexed[i] != linear[i]) {
+			printf("after %s: lookup %d: expected %d, got %d\n",
+			       what, i, linear[i], indexed[i]);
+			return -EINVAL;
+		}
+	}
+
+	fdt_node_offset_by_phandle(fdt, phandle);
+	fdt_node_offset_by_compatible(fdt, -1, TEST_COMPAT);
+	fdt_path_offset(fdt, TEST_PATH);
+
+	return 0;
+}
+
+/* Add the test node with its phandle and compatible string */
+static int add_test_node(void *fdt, uint32_t phandle)
+{
+	int node, ret;
+
+	node = fdt_add_subnode(fdt, 0, TEST_NODE);
+	if (node < 0)
+		return node;
+	ret = check_change(fdt, "fdt_add_subnode", phandle);
+	if (ret)
+		return ret;
+
+	ret = fdt_setprop_u32(fdt, node, "phandle", phandle);
+	if (!ret)
+		ret = fdt_setprop_string(fdt, node, "compatible", TEST_COMPAT);
+	if (ret)
+		return ret;
+	ret = check_change(fdt, "fdt_setprop", phandle);
+	if (ret)
+		return ret;
+
+	return node;
+}
+
+/*
+ * Change a copy of the control device tree, which is indexed while it is
+ * in gd->fdt_blob, and check that the index follows each change
+ */
+static int run_invalidate_test(void)
+{
+	const void *control = gd->fdt_blob;
+	int size = fdt_totalsize(control) + 0x1000;
+	uint32_t phandle;
+	void *fdt;
+	int node, ret;
+
+	fdt = malloc(size);
+	if (!fdt)
+		return -ENOMEM;
+	ret = fdt_open_into(control, fdt, size);
+	if (ret)
+		goto out;
+	gd->fdt_blob = fdt;
+	phandle = fdt_get_max_phandle(fdt) + 1;
+
+	ret = check_change(fdt, "fdt_open_into", phandle);
+	if (ret)
+		goto out;
+
+	node = add_test_node(fdt, phandle);
+	if (node < 0) {
+		ret = node;
+		goto out;
+	}
+	ret = fdt_del_node(fdt, node);
+	if (!ret)
+		ret = check_change(fdt, "fdt_del_node", phandle);
+	if (ret)
+		goto out;
+
+	node = add_test_node(fdt, phandle);
+	if (node < 0) {
+		ret = node;
+		goto out;
+	}
+	ret = fdt_nop_node(fdt, node);
+	if (!ret)
+		ret = check_change(fdt, "fdt_nop_node", phandle);
+
+out:
+	gd->fdt_blob = control;
+	fdt_index_invalidate(fdt);
+	free(fdt);
+	printf("%-12s %s\n", "invalidate", ret ? "failed" : "ok");
+
+	return ret;
+}
+
+int do_ut_fdt_index(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	int ret = 0;
+
+	if (!gd->fdt_blob) {
+		printf("No control device tree\n");
+		return CMD_RET_FAILURE;
+	}
+
+	ret |= run_test("phandle", lookup_phandles);
+	ret |= run_test("compatible", lookup_compatibles);
+	ret |= run_test("path", lookup_paths);
+	ret |= run_invalidate_test();
+
+	printf("Test %s\n", ret ? "failed" : "passed");
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test and benchmark for software RSA
+ *
+ * For each key size this checks a signature against the message which was
+ * signed, then repeats the check and reports how long one takes. This is
+ * the public key operation done by rsa_verify() for each signed FIT image,
+ * without the hashing. The keys were made with 'openssl genrsa' for this
+ * test only.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <errno.h>
+#include <u-boot/rsa.h>
+#include <u-boot/rsa-mod-exp.h>
+#include <test/suites.h>
+
+/* Number of signature checks timed for each key */
+#define RSA_UT_LOOPS	20
+
+static const u8 rsa2048_modulus[] __aligned(4) = {
+	0xb7, 0xcc, 0xfd, 0x37, 0x10, 0xd4, 0x02, 0x73, 0xc3, 0x1d, 0x81, 0xc1,
+	0x89, 0xd7, 0x68, 0xfe, 0x20, 0x0a, 0x9a, 0xf4, 0xd0, 0x4d, 0x5b, 0xb2,
+	0xea, 0xe5, 0xd2, 0x4e, 0x52, 0x54, 0x99, 0x23, 0xaa, 0x00, 0xbe, 0xf8,
+	0x7a, 0x40, 0x1c, 0xbc, 0xc5, 0x93, 0x13, 0xc4, 0x87, 0xa5, 0x38, 0x5c,
+	0x3f, 0x14, 0x38, 0x40, 0x60, 0x86, 0x5c, 0x73, 0x67, 0x14, 0x09, 0xb1,
+	0x62, 0xb8, 0x43, 0x9c, 0x1b, 0x02, 0xfc, 0x4a, 0x1f, 0xb5, 0xfe, 0x3f,
+	0x53, 0x2c, 0x9c, 0x17, 0x8f, 0x89, 0x00, 0x20, 0x61, 0x9f, 0x6a, 0xab,
+	0x8c, 0x7f, 0x6e, 0xe6, 0x05, 0xeb, 0xc6, 0xc6, 0xd7, 0x75, 0xfb, 0x88,
+	0xdd, 0x11, 0x4b, 0x0f, 0x57, 0xa4, 0x12, 0x7c, 0xeb, 0xc1, 0x4a, 0x91,
+	0x7a, 0x07, 0xd1, 0x2e, 0xb5, 0x44, 0x13, 0xc4, 0x31, 0x6c, 0x7b, 0xf2,
+	0x7e, 0xa0, 0xae, 0xd0, 0x5f, 0x19, 0x6e, 0x5b, 0xb2, 0x51, 0x59, 0xa2,
+	0xd6, 0x71, 0x1f, 0x65, 0x17, 0x26, 0x40, 0xf4, 0xba, 0x1c, 0xf4, 0xf5,
+	0x98, 0xe8, 0xc5, 0x56, 0xed, 0x85, 0xe2, 0x57, 0xc5, 0x43, 0x2c, 0x47,
+	0xc4, 0x0a, 0xd9, 0x51, 0x14, 0xee, 0xb6, 0xb0, 0x1d, 0x69, 0x20, 0x47,
+	0xce, 0xa2, 0x5a, 0x6e, 0x72, 0x13, 0xf8, 0x78, 0x49, 0xbe, 0x22, 0x6f,
+	0xec, 0xc4, 0xc5, 0x84, 0xea, 0x9f, 0x3d, 0xc7, 0x1c, 0x73, 0xc1, 0x2b,
+	0x94, 0xd7, 0x20, 0x78, 0x38, 0x23, 0xc0, 0x74, 0x87, 0x0d, 0x0e, 0xe4,
+	0xa7, 0x65, 0xfb, 0x3f, 0x96, 0xe6, 0x66, 0xa6, 0x92, 0xbc, 0x79, 0xe4,
+	0xb5, 0xb3, 0x9c, 0x78, 0x7c, 0xf1, 0x33, 0x7b, 0x99, 0x19, 0x46, 0xb9,
+	0xca, 0x76, 0x9d, 0xc4, 0xe3, 0xf0, 0x75, 0x46, 0x90, 0x7d, 0x09, 0x79,
+	0xf4, 0xc4, 0xc7, 0xa7, 0x5a, 0x86, 0x91, 0x17, 0xd8, 0x0b, 0xb0, 0xd5,
+	0xc8, 0x3a, 0x3a, 0x4f,
+};
+
+static const u8 rsa2048_rr[] __aligned(4) = {
+	0x41, 0xfa, 0xce, 0xdf, 0xb2, 0x5e, 0x19, 0x8d, 0xba, 0x8f, 0x97, 0xd0,
+	0xfb, 0x60, 0xa9, 0x86, 0x26, 0x20, 0x29, 0xe1, 0xf8, 0xab, 0x57, 0xe5,
+	0x7c, 0x7f, 0x76, 0x60, 0x82, 0x33, 0xbf, 0xb4, 0x68, 0x8b, 0x6d, 0x3e,
+	0xcc, 0x47, 0x9e, 0x81, 0x4e, 0x3f, 0xd6, 0xac, 0x49, 0xc1, 0xb3, 0xab,
+	0x7a, 0x3a, 0xcd, 0x98, 0x78, 0xb4, 0x2d, 0xb6, 0x0c, 0x16, 0x4a, 0x81,
+	0x76, 0xb7, 0xab, 0x38, 0x09, 0x11, 0x65, 0xd5, 0xeb, 0xef, 0x43, 0xcb,
+	0xe8, 0x10, 0xc8, 0x53, 0xef, 0x8a, 0x22, 0x93, 0x7d, 0x9d, 0xa8, 0x28,
+	0x59, 0x5c, 0x70, 0x35, 0x89, 0x5b, 0x04, 0xcc, 0xd3, 0xd4, 0x93, 0x2e,
+	0xfd, 0xb4, 0x29, 0x30, 0xc6, 0xfa, 0x8d, 0x7f, 0x40, 0x26, 0x4a, 0x64,
+	0x52, 0xa7, 0x7e, 0xca, 0x53, 0xe5, 0xfc, 0x1e, 0xce, 0x94, 0xd4, 0x53,
+	0x99, 0xbe, 0xaa, 0x61, 0x5f, 0xa7, 0xe7, 0xcf, 0x4b, 0xb7, 0xd6, 0xbe,
+	0xdc, 0x52, 0xbc, 0xc1, 0x7d, 0x97, 0xf4, 0x04, 0xa1, 0x1b, 0x13, 0xd6,
+	0xf7, 0x00, 0x43, 0x29, 0xa1, 0x5d, 0x63, 0xd9, 0xb7, 0x52, 0x62, 0x34,
+	0xb3, 0xfb, 0x35, 0x9b, 0x40, 0x32, 0x9a, 0xe1, 0xdd, 0x7c, 0x2a, 0x25,
+	0x18, 0xa6, 0x28, 0xa6, 0x8e, 0xc5, 0x77, 0xb5, 0x13, 0x2d, 0xe6, 0xf7,
+	0x26, 0x43, 0x57, 0xc7, 0xf9, 0x5e, 0xc3, 0xe3, 0x38, 0x40, 0x7e, 0x8b,
+	0xe1, 0x23, 0x9e, 0x7f, 0xec, 0xe6, 0x10, 0x61, 0x80, 0xf8, 0x72, 0xad,
+	0x9f, 0x9b, 0xa3, 0x12, 0xc7, 0xfd, 0x26, 0xbe, 0x0a, 0xec, 0xea, 0xd7,
+	0x6f, 0x4f, 0xd8, 0x3e, 0x41, 0xed, 0xc8, 0xb4, 0x15, 0xe8, 0xf3, 0x7e,
+	0x63, 0xe8, 0x65, 0x75, 0xe1, 0xab, 0xe2, 0xcc, 0x18, 0xd4, 0x91, 0xab,
+	0xfc, 0x16, 0x16, 0x03, 0x4b, 0x42, 0x16, 0x69, 0xf7, 0x22, 0x6b, 0x2d,
+	0xdf, 0xbf, 0xbc, 0xb1,
+};
+
+static const u8 rsa2048_sig[] __aligned(4) = {
+	0x8b, 0x39, 0x28, 0xce, 0x42, 0x76, 0x38, 0x57, 0x68, 0xb3, 0x83, 0xb3,
+	0x9d, 0xa4, 0xe6, 0xdd, 0x16, 0x8d, 0x10, 0xd4, 0x7c, 0xc9, 0x18, 0xe7,
+	0x8d, 0x72, 0x56, 0xe3, 0x40, 0xf5, 0x59, 0x4d, 0xdc, 0x09, 0x27, 0x06,
+	0x93, 0xe2, 0x21, 0xe8, 0x9f, 0xd3, 0x8c, 0x0f, 0xa9, 0xdb, 0x36, 0x8c,
+	0x12, 0x03, 0xbe, 0x07, 0xec, 0x77, 0x1b, 0xd6, 0xb2, 0x5b, 0x1c, 0x78,
+	0x34, 0x61, 0xaf, 0xb1, 0x35, 0x72, 0xa6, 0x9e, 0xc6, 0x3c, 0x27, 0xa6,
+	0xca, 0x74, 0xd1, 0x6b, 0xef, 0xb7, 0x0a, 0x11, 0xfc, 0x97, 0x1c, 0x29,
+	0x9d, 0x51, 0x56, 0xb0, 0x1d, 0x43, 0x70, 0x8b, 0x45, 0xaf, 0xaf, 0x06,
+	0x7a, 0x10, 0x15, 0x47, 0x43, 0xc9, 0x43, 0x7e, 0x48, 0xd8, 0xe5, 0x82,
+	0xb9, 0xa5, 0x36, 0x36, 0x59, 0x0b, 0xc1, 0xf5, 0x9f, 0xb2, 0xb1, 0x40,
+	0xd6, 0x50, 0x59, 0xb5, 0xdd, 0xe2, 0x16, 0xba, 0x6b, 0x36, 0x48, 0xf6,
+	0x38, 0x50, 0x31, 0x81, 0xcd, 0x34, 0x36, 0xcc, 0xf6, 0x88, 0x9b, 0x03,
+	0x2c, 0xbd, 0x88, 0x22, 0x57, 0xfb, 0x8b, 0x00, 0x11, 0xaa, 0x54, 0xc1,
+	0x6c, 0xd8, 0x1d, 0x4a, 0xe2, 0x54, 0x36, 0xc5, 0x3b, 0x52, 0x35, 0xd6,
+	0xd6, 0x51, 0x25, 0x7b, 0x49, 0xfe, 0xe2, 0x54, 0xf0, 0x87, 0x86, 0x5a,
+	0x22, 0xb5, 0xd9, 0xa8, 0x71, 0x41, 0x56, 0x5f, 0x2e, 0xfe, 0xfb, 0x9f,
+	0x98, 0x53, 0x0d, 0x22, 0x9e, 0xc8, 0x21, 0xcc, 0x8d, 0xb4, 0xa8, 0xd1,
+	0x00, 0x63, 0x3d, 0xf3, 0x83, 0x77, 0x8b, 0x41, 0x2a, 0xeb, 0xdd, 0x57,
+	0xa1, 0x2c, 0xea, 0xc0, 0xaf, 0x1f, 0xb7, 0x79, 0xce, 0x2f, 0x7a, 0xda,
+	0x97, 0xfe, 0x68, 0xbd, 0xd5, 0x66, 0x92, 0x61, 0xa8, 0xd4, 0xcb, 0x09,
+	0xed, 0xa4, 0x59, 0x8a, 0x7f, 0xd5, 0x11, 0x1a, 0x25, 0xcf, 0x28, 0x64,
+	0xcb, 0x21, 0xdf, 0x38,
+};
+
+#define RSA2048_N0INV	0xd7c96351
+
+static const u8 rsa4096_modulus[] __aligned(4) = {
+	0xd8, 0x27, 0x5a, 0xb5, 0xca, 0x87, 0xc3, 0xfe, 0xf3, 0x24, 0xda, 0xb3,
+	0x48, 0x93, 0xa8, 0xd4, 0x1e, 0x71, 0xbc, 0xa9, 0x36, 0x66, 0x0c, 0x02,
+	0x96, 0x6f, 0xd7, 0xe6, 0xb6, 0x95, 0x90, 0xb4, 0x29, 0xf2, 0xe5, 0x62,
+	0x70, 0xea, 0x4b, 0x13, 0xa9, 0xa2, 0x68, 0xf1, 0x24, 0x2c, 0xca, 0x80,
+	0xdb, 0xa2, 0x6a, 0xf9, 0xb4, 0xfb, 0x8a, 0xe6, 0x31, 0x5e, 0x41, 0x92,
+	0x3a, 0xe2, 0xc3, 0x01, 0xad, 0x14, 0x47, 0x59, 0x6c, 0xfa, 0x92, 0xb5,
+	0x0a, 0x00, 0x1f, 0xd4, 0xbe, 0x0f, 0xaa, 0x49, 0xfd, 0xb8, 0x21, 0x72,
+	0xfd, 0x37, 0xb1, 0x7a, 0x29, 0xc6, 0xaf, 0xa3, 0x38, 0xe7, 0xc6, 0xcb,
+	0x12, 0x99, 0x6a, 0x25, 0x6b, 0xc2, 0xc6, 0x34, 0xbb, 0x17, 0x42, 0x03,
+	0x0c, 0xcd, 0x6e, 0xb4, 0xcc, 0x13, 0x66, 0x92, 0xb4, 0x42, 0xc1, 0x88,
+	0x73, 0x2d, 0x70, 0xb5, 0xf0, 0x1c, 0x62, 0x44, 0xfd, 0x69, 0x97, 0x58,
+	0xfc, 0xd1, 0x13, 0x8a, 0x79, 0x00, 0xf7, 0xa4, 0x5e, 0x1a, 0x8f, 0x77,
+	0x4b, 0x22, 0xd8, 0x55, 0x12, 0x57, 0x2e, 0x82, 0x73, 0xea, 0xeb, 0xd2,
+	0x06, 0x01, 0xa4, 0xeb, 0x29, 0xa0, 0x1a, 0x17, 0x98, 0xef, 0xdf, 0x5c,
+	0x8c, 0x4e, 0xc5, 0x88, 0x63, 0x8d, 0x89, 0x6b, 0xbb, 0xc1, 0xae, 0x57,
+	0x27, 0xe8, 0x6c, 0x46, 0x63, 0x19, 0xca, 0x2a, 0xea, 0xd1, 0xd0, 0x99,
+	0xbf, 0x4c, 0xa3, 0xac, 0x7f, 0xd1, 0x2a, 0x6d, 0xb7, 0xa7, 0x5a, 0x76,
+	0xc2, 0x22, 0x4d, 0x50, 0xa0, 0xb8, 0x53, 0x5f, 0xfb, 0xd8, 0xd3, 0x7c,
+	0xc9, 0x6e, 0x99, 0xc6, 0x82, 0x25, 0x9d, 0x93, 0x4e, 0xe7, 0x46, 0x0e,
+	0x6e, 0x03, 0xf9, 0x3f, 0x31, 0x39, 0x30, 0x4d, 0x68, 0x1f, 0x3a, 0x57,
+	0x6a, 0xd1, 0x37, 0xbe, 0x72, 0x44, 0x4a, 0xb0, 0x75, 0xec, 0xe7, 0xc0,
+	0x05, 0xd0, 0x67, 0x12, 0x64, 0x2e, 0x48, 0x12, 0x4c, 0x4f, 0xed, 0x1d,
+	0x2b, 0x5d, 0x70, 0x16, 0xc1, 0xb7, 0xb4, 0x3c, 0x97, 0xa4, 0x2d, 0xdc,
+	0x8a, 0x78, 0x74, 0xa0, 0x29, 0x9c, 0x11, 0x30, 0x6b, 0x34, 0x31, 0x5a,
+	0x46, 0x2a, 0x49, 0x71, 0x4e, 0x13, 0x46, 0x6a, 0x16, 0xca, 0xba, 0x81,
+	0xe5, 0x3c, 0x8d, 0xa3, 0x11, 0x20, 0xae, 0xa7, 0x36, 0x98, 0x20, 0xb6,
+	0x49, 0x3f, 0xd4, 0x50, 0xc4, 0x29, 0x6a, 0xe8, 0xba, 0x56, 0x6a, 0x13,
+	0xc2, 0x29, 0x18, 0x0d, 0x4b, 0x66, 0x40, 0x02, 0xc1, 0x4f, 0x85, 0xd3,
+	0xbc, 0xf2, 0xee, 0x81, 0x94, 0x75, 0xc9, 0x56, 0x79, 0x99, 0x5f, 0xcd,
+	0xd2, 0x4c, 0xd4, 0xaf, 0xc7, 0x92, 0x99, 0x3a, 0x65, 0x3d, 0x05, 0xb0,
+	0xf0, 0xfc, 0xb5, 0x0f, 0x6f, 0x57, 0x8a, 0xd5, 0xbd, 0x39, 0x6b, 0x72,
+	0xe0, 0x78, 0x4c, 0x2a, 0xaf, 0x2c, 0xe5, 0xf2, 0x3a, 0x3c, 0x3d, 0x15,
+	0x38, 0xd5, 0x54, 0x8d, 0x82, 0x7b, 0x63, 0xdb, 0xef, 0x72, 0xa0, 0xd3,
+	0xe2, 0xa4, 0x26, 0x9b, 0x14, 0xb7, 0xa6, 0x0e, 0xc9, 0xb2, 0xfe, 0x63,
+	0x74, 0x90, 0x48, 0x36, 0xea, 0x72, 0xd6, 0xa0, 0xc7, 0xd3, 0xa5, 0xc8,
+	0xb9, 0xdc, 0x5d, 0x26, 0x2a, 0x7d, 0x3b, 0x9d, 0xf4, 0x6f, 0x8f, 0x2f,
+	0xba, 0x30, 0xc6, 0x63, 0xeb, 0x63, 0xfe, 0x38, 0x08, 0xc3, 0x51, 0x07,
+	0xc0, 0x89, 0x4e, 0xcb, 0x03, 0x43, 0x0b, 0xca, 0x23, 0xe6, 0x6b, 0xef,
+	0x3f, 0xe8, 0xda, 0x16, 0xbd, 0xef, 0x1a, 0x34, 0x98, 0x1e, 0x3b, 0x51,
+	0xbb, 0xae, 0x9d, 0x38, 0x78, 0xc6, 0xd5, 0xaf, 0xcf, 0x90, 0xcb, 0xcc,
+	0x6a, 0x6d, 0x46, 0xd8, 0x8c, 0xfb, 0x92, 0xde, 0x23, 0xfc, 0xb4, 0xff,
+	0x44, 0x4c, 0x67, 0xa2, 0xbe, 0x88, 0xe4, 0x00, 0x53, 0xea, 0x8e, 0x81,
+	0x49, 0x52, 0x8f, 0x03, 0x0c, 0xea, 0xe0, 0x1b,
+};
+
+static const u8 rsa4096_rr[] __aligned(4) = {
+	0x4b, 0xd0, 0xd3, 0xa8, 0x17, 0x90, 0xc7, 0x11, 0xbf, 0x09, 0xc0, 0x6b,
+	0x6f, 0x39, 0xb3, 0xc4, 0x9b, 0x2d, 0x78, 0x4b, 0xf4, 0xc7, 0x14, 0x69,
+	0x93, 0xdc, 0x2c, 0xc9, 0x4e, 0x22, 0x4f, 0x4b, 0x11, 0x29, 0xf3, 0x49,
+	0x3c, 0xef, 0x0d, 0x0e, 0x4f, 0xc1, 0x7e, 0xf2, 0x59, 0x93, 0xfd, 0x7f,
+	0x80, 0x4b, 0x4e, 0x26, 0x5c, 0xe4, 0xcd, 0xaa, 0xbc, 0xb5, 0xdb, 0x50,
+	0x14, 0x55, 0x09, 0x47, 0xed, 0x30, 0xff, 0x10, 0x03, 0x6d, 0x88, 0xc8,
+	0x5a, 0xdc, 0xb4, 0xf7, 0xe5, 0x1e, 0x34, 0xb4, 0x67, 0x20, 0xf9, 0x3b,
+	0x00, 0xd5, 0x48, 0x6d, 0xf4, 0xca, 0xa5, 0xf0, 0x06, 0xfb, 0x28, 0x25,
+	0xc7, 0x66, 0xff, 0x53, 0xa4, 0x1d, 0x54, 0xa1, 0x90, 0x08, 0xe7, 0x3f,
+	0x1a, 0x28, 0x59, 0xe6, 0x18, 0xdd, 0xb1, 0xbf, 0x3a, 0x1f, 0x05, 0x58,
+	0x62, 0x19, 0xc0, 0x9e, 0xfe, 0xda, 0x8c, 0x54, 0x9b, 0xef, 0x55, 0xab,
+	0x19, 0xe7, 0x16, 0x9d, 0xa9, 0xc3, 0x24, 0xce, 0x7e, 0x95, 0x26, 0xb9,
+	0x4e, 0x89, 0xc8, 0xa7, 0xb1, 0x0a, 0xbd, 0xe8, 0xfe, 0x8a, 0x05, 0x51,
+	0xe5, 0xe2, 0x88, 0xdb, 0x8e, 0xa2, 0x6e, 0x86, 0x5b, 0x1c, 0x6e, 0x38,
+	0x1f, 0x62, 0xc6, 0xb3, 0xd0, 0x5c, 0x6d, 0x4a, 0x11, 0x78, 0xd5, 0x33,
+	0xb6, 0x80, 0x32, 0xcf, 0x6c, 0x13, 0x8c, 0xca, 0xea, 0x68, 0x68, 0xe6,
+	0xfa, 0xfd, 0xa5, 0x17, 0xda, 0xc1, 0xf7, 0x7c, 0x94, 0x1f, 0xe2, 0x51,
+	0x50, 0x1c, 0x46, 0x77, 0x84, 0x5e, 0x6e, 0x6c, 0x05, 0x9f, 0x00, 0xa4,
+	0xc0, 0xe6, 0xab, 0x73, 0xb9, 0xf8, 0x8a, 0x3b, 0x27, 0x8a, 0x78, 0x7c,
+	0x59, 0xec, 0x83, 0xa6, 0xde, 0xef, 0x52, 0x66, 0xde, 0xd0, 0x4e, 0x9f,
+	0x55, 0xf7, 0xa8, 0xec, 0x2d, 0x5d, 0x8a, 0x18, 0x6b, 0xaf, 0xd0, 0x2f,
+	0x49, 0xc0, 0xa8, 0x4f, 0x57, 0xb6, 0x36, 0xfa, 0x9f, 0x0a, 0x33, 0x86,
+	0x5f, 0xa7, 0xb0, 0xa7, 0x27, 0x95, 0x4f, 0x66, 0x75, 0x7b, 0xc6, 0x97,
+	0xda, 0x19, 0x50, 0x32, 0x72, 0xcd, 0x10, 0x96, 0x3c, 0x57, 0x51, 0x52,
+	0x47, 0x26, 0x37, 0xf3, 0xff, 0x73, 0x41, 0x96, 0x66, 0x34, 0xca, 0xb1,
+	0x92, 0xa5, 0x9a, 0xe8, 0xc8, 0x69, 0xac, 0x72, 0x80, 0xbe, 0x9b, 0x4d,
+	0x2a, 0x7f, 0x91, 0x3e, 0xb7, 0xb1, 0xa8, 0xd0, 0xdb, 0xb2, 0x9d, 0x5c,
+	0x55, 0x1d, 0x80, 0xee, 0xbc, 0x63, 0x9d, 0xae, 0x16, 0x5a, 0x72, 0x9d,
+	0x81, 0x5f, 0x39, 0x21, 0xac, 0xb0, 0x34, 0xd8, 0xc7, 0xba, 0x86, 0xd3,
+	0x1d, 0xf2, 0xc8, 0x21, 0xa0, 0x6b, 0xd1, 0xd7, 0x2d, 0x36, 0xa5, 0x2e,
+	0x7f, 0x86, 0x8c, 0xfc, 0xa9, 0x7e, 0xa7, 0xc3, 0x46, 0xd7, 0x5f, 0x02,
+	0x33, 0x7f, 0x6a, 0xf0, 0xfb, 0x5e, 0x97, 0x36, 0x22, 0x57, 0x50, 0x8d,
+	0x43, 0xc3, 0x5f, 0xfb, 0x3e, 0xb6, 0xb8, 0x2e, 0x90, 0xe5, 0xdd, 0x1f,
+	0xa6, 0x87, 0xd4, 0x9b, 0xcb, 0x3a, 0x73, 0x50, 0x5c, 0x0e, 0xd2, 0x7f,
+	0x03, 0x5d, 0x92, 0xcd, 0xa1, 0xf0, 0xf1, 0x71, 0x04, 0xdc, 0x8c, 0x29,
+	0x3f, 0x54, 0x5e, 0xcb, 0x81, 0x9d, 0xea, 0x04, 0x3f, 0xbb, 0x9d, 0x7d,
+	0x09, 0x6b, 0xdf, 0xdf, 0x7d, 0x10, 0x60, 0x04, 0xdd, 0xd7, 0x4c, 0x67,
+	0xd6, 0x74, 0x4d, 0x64, 0x2c, 0x17, 0x0b, 0x01, 0xa8, 0x74, 0xa9, 0xfa,
+	0x5a, 0x0d, 0x9d, 0x46, 0x87, 0x9e, 0xb7, 0x8f, 0xb5, 0x63, 0x9a, 0xb9,
+	0xff, 0x7d, 0x3a, 0xbb, 0x55, 0xf9, 0xa4, 0x4e, 0xb4, 0x4a, 0x3b, 0x28,
+	0xcb, 0xf6, 0xbe, 0xd5, 0x18, 0xd1, 0x08, 0x11, 0x2b, 0x0f, 0x50, 0xc1,
+	0x27, 0xcc, 0x55, 0xb0, 0xdf, 0xf0, 0x3e, 0xaf, 0x5d, 0x46, 0x00, 0x04,
+	0x47, 0xa7, 0x07, 0xe3, 0xaf, 0xeb, 0xb4, 0xf9,
+};
+
+static const u8 rsa4096_sig[] __aligned(4) = {
+	0x73, 0x4b, 0x1b, 0x40, 0xce, 0x22, 0x28, 0x3e, 0x30, 0x0a, 0x1b, 0x43,
+	0x21, 0x31, 0x8c, 0x5e, 0xcd, 0xf2, 0xfd, 0x57, 0xd6, 0xc4, 0x07, 0x20,
+	0x59, 0x4a, 0x53, 0x06, 0x46, 0x2f, 0x56, 0xe5, 0xbd, 0x92, 0xe5, 0x62,
+	0xd9, 0xeb, 0x5c, 0xaa, 0x75, 0x5e, 0x47, 0xce, 0x48, 0x0c, 0x98, 0x42,
+	0x7c, 0xaf, 0x4b, 0x9d, 0x1c, 0x1b, 0x2f, 0xa2, 0x72, 0x8b, 0x09, 0x15,
+	0x7b, 0x4b, 0x5f, 0x73, 0x1e, 0xc1, 0xfc, 0x77, 0xe5, 0xd4, 0xa5, 0xca,
+	0xe9, 0x71, 0x77, 0x65, 0x0c, 0x94, 0xaf, 0x4c, 0x46, 0x27, 0x8e, 0xbf,
+	0x44, 0x62, 0xab, 0x6a, 0xe4, 0x32, 0x87, 0x37, 0x49, 0xb5, 0x27, 0x51,
+	0x75, 0x95, 0xdb, 0x52, 0x55, 0x58, 0x94, 0x73, 0x0c, 0x84, 0x04, 0x53,
+	0x1e, 0xaf, 0xa9, 0x47, 0xba, 0xa0, 0x30, 0x03, 0x81, 0x9a, 0xe7, 0x09,
+	0x9b, 0x50, 0xb5, 0x59, 0x58, 0x4b, 0x3e, 0x23, 0x3c, 0xb9, 0x5a, 0x19,
+	0xf2, 0xc1, 0x60, 0x0a, 0x64, 0xe8, 0x50, 0xaa, 0x53, 0x42, 0xe0, 0x93,
+	0xa9, 0x57, 0x82, 0x7e, 0x00, 0x2f, 0x6c, 0xae, 0xdd, 0xf6, 0xdf, 0x69,
+	0xca, 0xc3, 0x3c, 0xd0, 0x0c, 0xda, 0x7d, 0x9f, 0x02, 0x6a, 0x14, 0x68,
+	0xc5, 0xb8, 0xdf, 0x5b, 0x88, 0x9d, 0xc4, 0x02, 0x30, 0x75, 0x2a, 0x16,
+	0xad, 0xc3, 0xdb, 0xfb, 0x5c, 0xbb, 0xd7, 0x11, 0xb2, 0x96, 0x38, 0xcc,
+	0x01, 0x2e, 0xb1, 0x10, 0xbe, 0xfc, 0xf5, 0x8e, 0x25, 0xb8, 0x8c, 0x2e,
+	0x1b, 0x7f, 0x94, 0xfc, 0xe6, 0xe6, 0x42, 0x05, 0x38, 0x41, 0x52, 0x4e,
+	0x67, 0xd0, 0xeb, 0x56, 0x0b, 0x6c, 0x6d, 0xb1, 0xa1, 0xf8, 0xba, 0xf6,
+	0xd9, 0x3d, 0xd2, 0x99, 0xce, 0xf7, 0xce, 0x50, 0x56, 0x03, 0x19, 0x3f,
+	0x52, 0x51, 0x4f, 0x1e, 0x1d, 0xbe, 0x81, 0xa0, 0xcd, 0x9f, 0x24, 0x25,
+	0x8d, 0xe1, 0xc5, 0x54, 0x0e, 0xae, 0x00, 0x67, 0x73, 0x3f, 0xb8, 0xe5,
+	0x60, 0x9a, 0x7d, 0x68, 0x99, 0xdd, 0x32, 0x0a, 0x5c, 0x72, 0x57, 0xd0,
+	0x9f, 0x9b, 0x93, 0x3a, 0x52, 0xa2, 0x75, 0x30, 0x57, 0x43, 0x68, 0xab,
+	0x6f, 0x7b, 0x8c, 0x8e, 0x50, 0x4b, 0x22, 0x64, 0x12, 0x73, 0x34, 0x14,
+	0x97, 0x70, 0x2b, 0x54, 0x5f, 0xf3, 0x95, 0x72, 0x29, 0x37, 0x30, 0x3d,
+	0x27, 0x1e, 0x68, 0x67, 0x46, 0xcf, 0x55, 0x2b, 0x31, 0x29, 0x59, 0x2c,
+	0xe7, 0xf9, 0x3f, 0xf2, 0x47, 0x81, 0xe1, 0x79, 0xef, 0x21, 0xe8, 0x70,
+	0x80, 0xe0, 0xa2, 0xeb, 0x38, 0xa3, 0xe7, 0x7c, 0x4d, 0x8e, 0x72, 0x41,
+	0x0e, 0x0a, 0x8e, 0x6d, 0x81, 0x66, 0x57, 0x59, 0xcb, 0x77, 0x59, 0xd1,
+	0x20, 0x07, 0x65, 0x78, 0x04, 0x17, 0xbf, 0x05, 0xf5, 0xe0, 0xec, 0xff,
+	0xc5, 0xf2, 0x4c, 0x67, 0xf6, 0x70, 0x2d, 0x44, 0xef, 0xba, 0x0d, 0x31,
+	0xd3, 0x4d, 0xd0, 0x51, 0xaf, 0x9a, 0xa7, 0xca, 0xcb, 0x3a, 0x74, 0x6b,
+	0x2b, 0x98, 0xc8, 0x95, 0x27, 0xed, 0xa9, 0x90, 0x9f, 0xd9, 0x75, 0x02,
+	0x95, 0x94, 0xc3, 0xbc, 0x8e, 0xf6, 0x52, 0x7f, 0x5b, 0xde, 0x14, 0x25,
+	0x22, 0x94, 0x6d, 0xf6, 0x1d, 0xba, 0x34, 0x6f, 0xc1, 0x8a, 0xe1, 0xe2,
+	0x4b, 0xf5, 0x5e, 0xff, 0x39, 0x1e, 0x5e, 0x50, 0x97, 0xa8, 0x58, 0xf4,
+	0xc1, 0xde, 0xeb, 0xa3, 0x4c, 0x3a, 0x81, 0x5f, 0x7c, 0x43, 0x7b, 0x5e,
+	0xf3, 0xb9, 0xfe, 0xe1, 0x6e, 0x97, 0xa5, 0xb3, 0x71, 0x66, 0x5b, 0xc4,
+	0x59, 0x24, 0xe1, 0xe7, 0xa8, 0x4d, 0x94, 0x2f, 0x00, 0x54, 0x83, 0x33,
+	0x11, 0xbd, 0x68, 0x97, 0xfe, 0x42, 0x9b, 0x32, 0xf2, 0xd7, 0xb4, 0x66,
+	0x61, 0x60, 0x58, 0x11, 0x41, 0xf0, 0x71, 0xf3, 0xce, 0x7f, 0xb7, 0x94,
+	0xe4, 0x70, 0x13, 0xd4, 0x3a, 0xbf, 0x70, 0x71,
+};
+
+#define RSA4096_N0INV	0x8b6a05ed
+
+/**
+ * struct rsa_ut_key - test key and signature
+ *
+ * @name:	Name of the test
+ * @bits:	Key length in bits
+ * @modulus:	Modulus, big endian
+ * @rr:		R^2 mod modulus, big endian
+ * @sig:	Signature of the message from rsa_ut_message(), big endian
+ * @n0inv:	-1 / modulus mod 2^32
+ */
+struct rsa_ut_key {
+	const char *name;
+	int bits;
+	const u8 *modulus;
+	const u8 *rr;
+	const u8 *sig;
+	u32 n0inv;
+};
+
+static const struct rsa_ut_key rsa_ut_keys[] = {
+	{ "rsa2048", 2048, rsa2048_modulus, rsa2048_rr, rsa2048_sig,
+	  RSA2048_N0INV },
+	{ "rsa4096", 4096, rsa4096_modulus, rsa4096_rr, rsa4096_sig,
+	  RSA4096_N0INV },
+};
+
+/* The signed message: PKCS#1 v1.5 style padding, then 32 bytes of data */
+static void rsa_ut_message(u8 *buf, int len)
+{
+	int i;
+
+	memset(buf, 0xff, len);
+	buf[0] = 0;
+	buf[1] = 1;
+	buf[len - 33] = 0;
+	for (i = 0; i < 32; i++)
+		buf[len - 32 + i] = i * 7;
+}
+
+static int run_test(const struct rsa_ut_key *key)
+{
+	u8 out[RSA_MAX_SIG_BITS / 8], expect[RSA_MAX_SIG_BITS / 8];
+	struct key_prop prop = {
+		.rr = key->rr,
+		.modulus = key->modulus,
+		.n0inv = key->n0inv,
+		.num_bits = key->bits,
+	};
+	int len = key->bits / 8;
+	ulong start, us;
+	int i, ret;
+
+	rsa_ut_message(expect, len);
+	ret = rsa_mod_exp_sw(key->sig, len, &prop, out);
+	if (ret) {
+		printf("%s: rsa_mod_exp_sw() failed (err=%d)\n", key->name,
+		       ret);
+		return ret;
+	}
+	if (memcmp(out, expect, len)) {
+		printf("%s: signature does not match the message\n",
+		       key->name);
+		return -EINVAL;
+	}
+
+	start = timer_get_us();
+	for (i = 0; i < RSA_UT_LOOPS; i++)
+		rsa_mod_exp_sw(key->sig, len, &prop, out);
+	us = (timer_get_us() - start) / RSA_UT_LOOPS;
+	printf("%-8s %d-bit signature check: %lu.%03lu ms\n", key->name,
+	       key->bits, us / 1000, us % 1000);
+
+	return 0;
+}
+
+int do_ut_rsa(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(rsa_ut_keys); i++)
+		ret |= run_test(&rsa_ut_keys[i]);
+
+	printf("Test %s\n", ret ? "failed" : "passed");
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
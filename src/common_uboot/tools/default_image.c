@@ -95,10 +95,13 @@ static void image_set_header(void *ptr, struct stat *sbuf, int ifd,
 
 	image_header_t * hdr = (image_header_t *)ptr;
 
-	checksum = crc32(0,
-			(const unsigned char *)(ptr +
-				sizeof(image_header_t)),
-			sbuf->st_size - sizeof(image_header_t));
+	if (params->data_crc_valid)
+		checksum = params->data_crc;
+	else
+		checksum = crc32(0,
+				 (const unsigned char *)(ptr +
+					sizeof(image_header_t)),
+				 sbuf->st_size - sizeof(image_header_t));
 
 	time = imagetool_get_source_date(params->cmdname, sbuf->st_mtime);
 	ep = params->ep;
@@ -110,6 +110,7 @@ struct environment {
 	unsigned char *flags;
 	char *data;
 	enum flag_scheme flag_scheme;
+	int dirty;
 };
 
 static struct environment environment = {
@@ -508,6 +509,14 @@ int fw_env_flush(struct env_opts *opts)
 	if (!opts)
 		opts = &default_opts;
 
+	/* Leave the flash alone if nothing was changed */
+	if (!environment.dirty) {
+#ifdef DEBUG
+		fprintf(stderr, "Environment unchanged, not writing\n");
+#endif
+		return 0;
+	}
+
 	/*
 	 * Update CRC
 	 */
@@ -518,6 +527,7 @@ int fw_env_flush(struct env_opts *opts)
 		fprintf(stderr, "Error: can't write fw_env to flash\n");
 		return -1;
 	}
+	environment.dirty = 0;
 
 	return 0;
 }
@@ -593,6 +603,12 @@ int fw_env_write(char *name, char *value)
 		/* Nothing to do */
 		return 0;
 
+	/* Setting the same value again does not change anything */
+	if (overwriting && !strcmp(oldval, value))
+		return 0;
+
+	environment.dirty = 1;
+
 	if (deleting || overwriting) {
 		if (*++nxt == '\0') {
 			*env = '\0';
@@ -730,6 +746,11 @@ int fw_env_set(int argc, char *argv[], struct env_opts *opts)
  *
  * Comments are allowed if the first character in the line is #
  *
+ * A line starting with ? prints the variable named after it, in the same
+ * format as fw_printenv, so that one script can both read and modify the
+ * environment while it is only loaded once. The environment is only written
+ * back if the script changed it.
+ *
  * Returns -1 and sets errno error codes:
  * 0	  - OK
  * -1     - Error
@@ -795,6 +816,25 @@ int fw_parse_script(char *fname, struct env_opts *opts)
 		if (!name)
 			continue;
 
+		/* Print a variable */
+		if (*name == '?') {
+			name = skip_blanks(name + 1);
+			if (!name)
+				continue;
+			val = skip_chars(name);
+			if (val)
+				*val = '\0';
+			val = fw_getenv(name);
+			if (val) {
+				printf("%s=%s\n", name, val);
+			} else {
+				fprintf(stderr, "## Error: \"%s\" not defined\n",
+					name);
+				ret = -1;
+			}
+			continue;
+		}
+
 		/* The first white space is the end of variable name */
 		val = skip_chars(name);
 		len = strlen(name);
@@ -1413,6 +1453,7 @@ int fw_env_open(struct env_opts *opts)
 
 	/* read environment from FLASH to local buffer */
 	environment.image = addr0;
+	environment.dirty = 0;
 
 	if (have_redund_env) {
 		redundant = addr0;
@@ -1441,6 +1482,7 @@ int fw_env_open(struct env_opts *opts)
 				"Warning: Bad CRC, using default environment\n");
 			memcpy(environment.data, default_environment,
 			       sizeof(default_environment));
+			environment.dirty = 1;
 		}
 	} else {
 		flag0 = *environment.flags;
@@ -1503,6 +1545,7 @@ int fw_env_open(struct env_opts *opts)
 				"Warning: Bad CRC, using default environment\n");
 			memcpy(environment.data, default_environment,
 			       sizeof(default_environment));
+			environment.dirty = 1;
 			dev_current = 0;
 		} else {
 			switch (environment.flag_scheme) {
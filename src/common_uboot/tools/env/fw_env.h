@@ -80,6 +80,10 @@ int fw_env_set(int argc, char *argv[], struct env_opts *opts);
  *  and ends with newline. No comments allowed on these lines.  Spaces inside
  *  the value are preserved verbatim.
  *
+ *  ?key prints the variable as "key=value", as fw_printenv does.
+ *
+ *  The environment is read once, and only written back if it changed.
+ *
  * Script Example:
  *
  *  netdev         eth0
@@ -91,6 +95,10 @@ int fw_env_set(int argc, char *argv[], struct env_opts *opts);
  *  # delete variable bar
  *
  *  bar
+ *
+ *  # print variable netdev
+ *
+ *  ?netdev
  */
 int fw_parse_script(char *fname, struct env_opts *opts);
 
@@ -136,6 +144,9 @@ int fw_env_write(char *name, char *value);
  *
  * @opts: encryption key, configuration file, defaults are used if NULL
  *
+ * Nothing is written if the RAM cache has not been modified by fw_env_write()
+ * since it was read.
+ *
  * Return:
  *  0 on success, -1 on failure (modifies errno)
  */
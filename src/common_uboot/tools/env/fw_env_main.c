@@ -97,17 +97,20 @@ void usage_env_set(void)
 		"\n"
 		"Script Syntax:\n"
 		"  key [space] value\n"
+		"  ?key\n"
 		"  lines starting with '#' are treated as comment\n"
 		"\n"
 		"  A variable without value will be deleted. Any number of spaces are\n"
 		"  allowed between key and value. Space inside of the value is treated\n"
-		"  as part of the value itself.\n"
+		"  as part of the value itself. '?key' prints the variable. The\n"
+		"  environment is only written if the script changes it.\n"
 		"\n"
 		"Script Example:\n"
 		"  netdev         eth0\n"
 		"  kernel_addr    400000\n"
 		"  foo            empty empty empty    empty empty empty\n"
 		"  bar\n"
+		"  ?netdev\n"
 		"\n");
 }
 
@@ -11,7 +11,79 @@
 #include "mkimage.h"
 #include <bootm.h>
 #include <image.h>
+#include <pthread.h>
 #include <version.h>
+#include <u-boot/crc.h>
+#include <u-boot/rsa.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+
+/* Most hash nodes in an image which are calculated in advance */
+#define FIT_HASH_MAX_NODES	8
+
+/*
+ * Amount of data fed to each algorithm in turn, so that an image with
+ * several hash nodes is only read from memory once
+ */
+#define FIT_HASH_CHUNK		(256 * 1024)
+
+/* Space for the public key used to check a signature in incremental mode */
+#define FIT_KEY_BLOB_SIZE	0x4000
+
+/**
+ * struct fit_hash_result - a hash value calculated in advance
+ *
+ * @node_name:	Name of the hash node
+ * @algo:	Algorithm named in the hash node
+ * @value:	Hash value
+ * @value_len:	Length of @value in bytes
+ * @ret:	0 if @value is valid, -EPROTONOSUPPORT if @algo is unknown
+ */
+struct fit_hash_result {
+	char *node_name;
+	char *algo;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+	int ret;
+};
+
+/**
+ * struct fit_hash_job - the hash values needed for one image node
+ *
+ * Jobs are kept until mkimage exits, since the FIT may be processed several
+ * times while making space for signatures, and the image data does not
+ * change in between.
+ *
+ * @image_name:	Name of the image node
+ * @data:	Image data (only valid until the job is done)
+ * @size:	Size of the image data
+ * @count:	Number of entries in @result
+ * @done:	true once @result has been filled in
+ * @check:	true if @result only holds the strongest of the image's hash
+ *		values, to be compared with the one already in the FIT
+ * @unchanged:	true if that comparison showed the image data is unchanged
+ * @result:	Hash values, one for each hash node
+ * @next:	Next job in the list
+ */
+struct fit_hash_job {
+	char *image_name;
+	const void *data;
+	size_t size;
+	int count;
+	bool done;
+	bool check;
+	bool unchanged;
+	struct fit_hash_result result[FIT_HASH_MAX_NODES];
+	struct fit_hash_job *next;
+};
+
+static struct fit_hash_job *fit_hash_jobs;
+
+/* Work queue shared by the hashing threads */
+static pthread_mutex_t fit_hash_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct fit_hash_job **fit_hash_queue;
+static int fit_hash_queue_len;
+static int fit_hash_queue_next;
 
 /**
  * fit_set_hash_value - set hash value in requested has node
@@ -43,6 +115,489 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 	return 0;
 }
 
+enum fit_hash_type {
+	FIT_HASH_OTHER,
+	FIT_HASH_CRC32,
+	FIT_HASH_SHA1,
+	FIT_HASH_SHA256,
+};
+
+/**
+ * struct fit_hash_ctx - state for one algorithm while hashing an image
+ *
+ * @type:	Algorithm, or FIT_HASH_OTHER if it is not hashed progressively
+ * @result:	Where to put the hash value
+ */
+struct fit_hash_ctx {
+	enum fit_hash_type type;
+	struct fit_hash_result *result;
+	union {
+		uint32_t crc;
+		sha1_context sha1;
+		sha256_context sha256;
+	};
+};
+
+/**
+ * fit_hash_job_run() - calculate all the hash values for an image
+ *
+ * The data is processed in chunks, with each algorithm seeing a chunk in
+ * turn, so the image is only read once whatever the number of hash nodes.
+ *
+ * @job:	Job to run
+ */
+static void fit_hash_job_run(struct fit_hash_job *job)
+{
+	struct fit_hash_ctx ctx[FIT_HASH_MAX_NODES];
+	const uint8_t *data = job->data;
+	size_t done, todo;
+	int i;
+
+	for (i = 0; i < job->count; i++) {
+		struct fit_hash_result *res = &job->result[i];
+		struct fit_hash_ctx *c = &ctx[i];
+
+		c->result = res;
+		if (IMAGE_ENABLE_CRC32 && !strcmp(res->algo, "crc32")) {
+			c->type = FIT_HASH_CRC32;
+			c->crc = 0;
+		} else if (IMAGE_ENABLE_SHA1 && !strcmp(res->algo, "sha1")) {
+			c->type = FIT_HASH_SHA1;
+			sha1_starts(&c->sha1);
+		} else if (IMAGE_ENABLE_SHA256 &&
+			   !strcmp(res->algo, "sha256")) {
+			c->type = FIT_HASH_SHA256;
+			sha256_starts(&c->sha256);
+		} else {
+			c->type = FIT_HASH_OTHER;
+			res->ret = calculate_hash(data, job->size, res->algo,
+						  res->value, &res->value_len);
+			if (res->ret)
+				res->ret = -EPROTONOSUPPORT;
+		}
+	}
+
+	for (done = 0; done < job->size; done += todo) {
+		todo = job->size - done;
+		if (todo > FIT_HASH_CHUNK)
+			todo = FIT_HASH_CHUNK;
+		for (i = 0; i < job->count; i++) {
+			struct fit_hash_ctx *c = &ctx[i];
+
+			switch (c->type) {
+			case FIT_HASH_CRC32:
+				c->crc = crc32(c->crc, data + done, todo);
+				break;
+			case FIT_HASH_SHA1:
+				sha1_update(&c->sha1, data + done, todo);
+				break;
+			case FIT_HASH_SHA256:
+				sha256_update(&c->sha256, data + done, todo);
+				break;
+			case FIT_HASH_OTHER:
+				break;
+			}
+		}
+	}
+
+	for (i = 0; i < job->count; i++) {
+		struct fit_hash_ctx *c = &ctx[i];
+		struct fit_hash_result *res = c->result;
+
+		switch (c->type) {
+		case FIT_HASH_CRC32:
+			*(uint32_t *)res->value = cpu_to_uimage(c->crc);
+			res->value_len = 4;
+			break;
+		case FIT_HASH_SHA1:
+			sha1_finish(&c->sha1, res->value);
+			res->value_len = SHA1_SUM_LEN;
+			break;
+		case FIT_HASH_SHA256:
+			sha256_finish(&c->sha256, res->value);
+			res->value_len = SHA256_SUM_LEN;
+			break;
+		case FIT_HASH_OTHER:
+			break;
+		}
+	}
+	job->data = NULL;
+	job->done = true;
+}
+
+static void *fit_hash_worker(void *arg)
+{
+	struct fit_hash_job *job;
+
+	for (;;) {
+		pthread_mutex_lock(&fit_hash_lock);
+		job = NULL;
+		if (fit_hash_queue_next < fit_hash_queue_len)
+			job = fit_hash_queue[fit_hash_queue_next++];
+		pthread_mutex_unlock(&fit_hash_lock);
+		if (!job)
+			break;
+		fit_hash_job_run(job);
+	}
+
+	return NULL;
+}
+
+/**
+ * fit_hash_find_job() - find the job for an image node
+ *
+ * @image_name:	Name of the image node
+ * @size:	Size of its data
+ * @return job, or NULL if none
+ */
+static struct fit_hash_job *fit_hash_find_job(const char *image_name,
+					      size_t size)
+{
+	struct fit_hash_job *job;
+
+	for (job = fit_hash_jobs; job; job = job->next) {
+		if (job->size == size && !strcmp(job->image_name, image_name))
+			return job;
+	}
+
+	return NULL;
+}
+
+/*
+ * Rank the algorithms used to decide whether an image has changed. Only
+ * cryptographic hashes are trusted for this; others rank 0 and are not used.
+ */
+static int fit_hash_algo_strength(const char *algo)
+{
+	static const char *const algos[] = { "sha1", "sha256" };
+	int i;
+
+	for (i = ARRAY_SIZE(algos) - 1; i >= 0; i--) {
+		if (!strcmp(algo, algos[i]))
+			return i + 1;
+	}
+
+	return 0;
+}
+
+static void fit_hash_job_clear(struct fit_hash_job *job)
+{
+	while (job->count) {
+		job->count--;
+		free(job->result[job->count].node_name);
+		free(job->result[job->count].algo);
+	}
+	job->done = false;
+	job->check = false;
+}
+
+/**
+ * fit_hash_job_fill() - work out which hash values a job calculates
+ *
+ * With @fingerprint, if every hash node in the image already has a value,
+ * only the strongest algorithm is kept, so that the stored value can be
+ * checked before going to the trouble of calculating the others. This is
+ * only done if that algorithm is sha1 or better.
+ *
+ * @job:	Job to fill in
+ * @fit:	FIT being processed
+ * @image_noffset: Offset of the image node
+ * @fingerprint: true to only check the image if possible
+ * @return 0 if OK, -ENOENT if the image has no data
+ */
+static int fit_hash_job_fill(struct fit_hash_job *job, const void *fit,
+			     int image_noffset, bool fingerprint)
+{
+	bool stored = true;
+	int noffset;
+	int best, i;
+
+	if (fit_image_get_data(fit, image_noffset, &job->data, &job->size))
+		return -ENOENT;
+
+	for (noffset = fdt_first_subnode(fit, image_noffset);
+	     noffset >= 0;
+	     noffset = fdt_next_subnode(fit, noffset)) {
+		const char *node_name = fit_get_name(fit, noffset, NULL);
+		struct fit_hash_result *res;
+		char *algo;
+
+		if (strncmp(node_name, FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (fit_image_hash_get_algo(fit, noffset, &algo))
+			continue;
+		if (job->count == FIT_HASH_MAX_NODES) {
+			fit_hash_job_clear(job);
+			return 0;
+		}
+		if (!fdt_getprop(fit, noffset, FIT_VALUE_PROP, NULL))
+			stored = false;
+		res = &job->result[job->count++];
+		memset(res, '\0', sizeof(*res));
+		res->node_name = strdup(node_name);
+		res->algo = strdup(algo);
+	}
+	if (!fingerprint || !stored || !job->count)
+		goto done;
+
+	for (best = 0, i = 1; i < job->count; i++) {
+		if (fit_hash_algo_strength(job->result[i].algo) >
+		    fit_hash_algo_strength(job->result[best].algo))
+			best = i;
+	}
+	if (!fit_hash_algo_strength(job->result[best].algo)) {
+		stored = false;
+		goto done;
+	}
+	if (best) {
+		struct fit_hash_result tmp = job->result[0];
+
+		job->result[0] = job->result[best];
+		job->result[best] = tmp;
+	}
+	while (job->count > 1) {
+		job->count--;
+		free(job->result[job->count].node_name);
+		free(job->result[job->count].algo);
+	}
+done:
+	job->check = fingerprint && stored;
+
+	return 0;
+}
+
+/**
+ * fit_hash_add_job() - set up a job for an image node, if needed
+ *
+ * @fit:	FIT being processed
+ * @image_noffset: Offset of the image node
+ * @fingerprint: true to check the existing hash values first
+ * @return new job, or NULL if there is nothing to do or the image has too
+ * many hash nodes (these are then hashed when the node is processed)
+ */
+static struct fit_hash_job *fit_hash_add_job(const void *fit,
+					     int image_noffset,
+					     bool fingerprint)
+{
+	struct fit_hash_job *job;
+	const char *image_name;
+	const void *data;
+	size_t size;
+
+	if (fit_image_get_data(fit, image_noffset, &data, &size))
+		return NULL;
+	image_name = fit_get_name(fit, image_noffset, NULL);
+	if (fit_hash_find_job(image_name, size))
+		return NULL;
+
+	job = calloc(1, sizeof(*job));
+	if (!job)
+		return NULL;
+	fit_hash_job_fill(job, fit, image_noffset, fingerprint);
+	if (!job->count) {
+		free(job);
+		return NULL;
+	}
+	job->image_name = strdup(image_name);
+	job->next = fit_hash_jobs;
+	fit_hash_jobs = job;
+
+	return job;
+}
+
+static int fit_hash_queue_add(struct fit_hash_job *job)
+{
+	struct fit_hash_job **queue;
+
+	queue = realloc(fit_hash_queue,
+			(fit_hash_queue_len + 1) * sizeof(*queue));
+	if (!queue)
+		return -ENOMEM;
+	fit_hash_queue = queue;
+	fit_hash_queue[fit_hash_queue_len++] = job;
+
+	return 0;
+}
+
+/* Run all the queued jobs, with one thread per CPU */
+static void fit_hash_run(void)
+{
+	pthread_t *threads;
+	int nthreads;
+	int i;
+
+	if (!fit_hash_queue_len)
+		return;
+
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads > fit_hash_queue_len)
+		nthreads = fit_hash_queue_len;
+	threads = nthreads > 1 ? calloc(nthreads, sizeof(*threads)) : NULL;
+	debug("Hashing %d images with %d threads\n", fit_hash_queue_len,
+	      nthreads);
+	for (i = 0; threads && i < nthreads; i++) {
+		if (pthread_create(&threads[i], NULL, fit_hash_worker, NULL))
+			break;
+	}
+	/* Whatever is left over (e.g. no threads could start) is done here */
+	fit_hash_worker(NULL);
+	while (i--)
+		pthread_join(threads[i], NULL);
+	free(threads);
+	fit_hash_queue_len = 0;
+	fit_hash_queue_next = 0;
+}
+
+/**
+ * fit_hash_check() - check whether an image has changed
+ *
+ * @fit:	FIT being processed
+ * @images_noffset: Offset of the /images node
+ * @job:	Job which calculated the image's strongest hash value
+ * @return true if the value matches the one stored in the FIT
+ */
+static bool fit_hash_check(const void *fit, int images_noffset,
+			   struct fit_hash_job *job)
+{
+	struct fit_hash_result *res = &job->result[0];
+	const void *value;
+	int noffset;
+	int len;
+
+	if (!job->done || res->ret)
+		return false;
+	noffset = fdt_subnode_offset(fit, images_noffset, job->image_name);
+	if (noffset >= 0)
+		noffset = fdt_subnode_offset(fit, noffset, res->node_name);
+	if (noffset < 0)
+		return false;
+	value = fdt_getprop(fit, noffset, FIT_VALUE_PROP, &len);
+
+	return value && len == res->value_len &&
+		!memcmp(value, res->value, len);
+}
+
+/**
+ * fit_hash_prepare() - calculate the image hashes using all CPUs
+ *
+ * This works out the values for all the hash nodes in all the images, with
+ * one thread per CPU each taking an image at a time. The values are then
+ * picked up by fit_image_process_hash().
+ *
+ * In incremental mode, images whose hash nodes all have values are first
+ * checked using a single (the strongest) algorithm. Images which match are
+ * marked unchanged and left alone; the rest are hashed in full.
+ *
+ * @fit:	FIT being processed
+ * @images_noffset: Offset of the /images node
+ * @incremental: true to skip images which have not changed
+ */
+static void fit_hash_prepare(const void *fit, int images_noffset,
+			     bool incremental)
+{
+	struct fit_hash_job *job;
+	int noffset;
+
+	for (noffset = fdt_first_subnode(fit, images_noffset);
+	     noffset >= 0;
+	     noffset = fdt_next_subnode(fit, noffset)) {
+		job = fit_hash_add_job(fit, noffset, incremental);
+		if (job && fit_hash_queue_add(job))
+			break;
+	}
+	fit_hash_run();
+	if (!incremental)
+		return;
+
+	for (job = fit_hash_jobs; job; job = job->next) {
+		if (!job->check)
+			continue;
+		if (fit_hash_check(fit, images_noffset, job)) {
+			job->check = false;
+			job->unchanged = true;
+			debug("Image '%s' is unchanged\n", job->image_name);
+			continue;
+		}
+		noffset = fdt_subnode_offset(fit, images_noffset,
+					     job->image_name);
+		fit_hash_job_clear(job);
+		if (noffset >= 0 &&
+		    !fit_hash_job_fill(job, fit, noffset, false) &&
+		    job->count && fit_hash_queue_add(job))
+			break;
+	}
+	fit_hash_run();
+}
+
+/**
+ * fit_hash_image_unchanged() - check if an image was found to be unchanged
+ *
+ * @image_name:	Name of the image node
+ * @size:	Size of its data
+ * @return true if the image need not be hashed or signed again
+ */
+static bool fit_hash_image_unchanged(const char *image_name, size_t size)
+{
+	struct fit_hash_job *job = fit_hash_find_job(image_name, size);
+
+	return job && job->unchanged;
+}
+
+/**
+ * fit_hash_get_checked() - get the hash value which showed an image unchanged
+ *
+ * @image_name:	Name of the image node
+ * @size:	Size of its data
+ * @return the hash value, or NULL if the image was not found to be unchanged
+ */
+static const struct fit_hash_result *fit_hash_get_checked(
+		const char *image_name, size_t size)
+{
+	struct fit_hash_job *job = fit_hash_find_job(image_name, size);
+
+	return job && job->unchanged ? &job->result[0] : NULL;
+}
+
+/**
+ * fit_hash_get_value() - get a hash value calculated in advance
+ *
+ * @image_name:	Name of the image node
+ * @node_name:	Name of the hash node
+ * @algo:	Algorithm required
+ * @size:	Size of the image data
+ * @value:	Returns the hash value
+ * @value_len:	Returns the length of the hash value
+ * @return 0 if found, -EPROTONOSUPPORT if the algorithm is not supported,
+ * -ENOENT if the value was not calculated in advance
+ */
+static int fit_hash_get_value(const char *image_name, const char *node_name,
+			      const char *algo, size_t size, uint8_t *value,
+			      int *value_len)
+{
+	struct fit_hash_job *job;
+	int i;
+
+	job = fit_hash_find_job(image_name, size);
+	if (!job || !job->done)
+		return -ENOENT;
+	for (i = 0; i < job->count; i++) {
+		struct fit_hash_result *res = &job->result[i];
+
+		if (strcmp(res->node_name, node_name) ||
+		    strcmp(res->algo, algo))
+			continue;
+		if (res->ret)
+			return res->ret;
+		memcpy(value, res->value, res->value_len);
+		*value_len = res->value_len;
+
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
 /**
  * fit_image_process_hash - Process a single subnode of the images/ node
  *
@@ -73,7 +628,11 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	ret = fit_hash_get_value(image_name, node_name, algo, size, value,
+				 &value_len);
+	if (ret == -ENOENT)
+		ret = calculate_hash(data, size, algo, value, &value_len);
+	if (ret) {
 		printf("Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
 		       algo, node_name, image_name);
 		return -EPROTONOSUPPORT;
@@ -184,6 +743,77 @@ static int fit_image_setup_sig(struct image_sign_info *info,
 	return 0;
 }
 
+/**
+ * fit_image_keep_sig() - leave an existing signature in place
+ *
+ * This is used in incremental mode for images which are unchanged. The
+ * signature is only kept if it uses the same hash algorithm as the value
+ * which showed the image to be unchanged, and verifies against that value
+ * with the public key in @keydir. The public key is still written to
+ * @keydest, as it would be when signing.
+ *
+ * @keydir:	Directory containing keys to use for signing
+ * @keydest:	Destination FDT blob to write public keys into
+ * @fit:	pointer to the FIT format image header
+ * @name:	name of the image or configuration node (used in errors)
+ * @noffset:	signature node offset
+ * @require_keys: "image" or "conf" to mark the key as required, else NULL
+ * @engine_id:	Engine to use for signing
+ * @checked:	Hash value which showed the image to be unchanged
+ * @return 0 if ok, -EAGAIN if the image must be signed again, other -ve on
+ * error
+ */
+static int fit_image_keep_sig(const char *keydir, void *keydest, void *fit,
+		const char *name, int noffset, const char *require_keys,
+		const char *engine_id, const struct fit_hash_result *checked)
+{
+	struct image_sign_info info;
+	const void *sig;
+	void *blob;
+	int sig_len;
+	int ret;
+
+	if (fit_image_setup_sig(&info, keydir, fit, name, noffset,
+				require_keys, engine_id))
+		return -1;
+
+	sig = fdt_getprop(fit, noffset, FIT_VALUE_PROP, &sig_len);
+	if (!sig || !checked || info.crypto->verify != rsa_verify ||
+	    strcmp(info.checksum->name, checked->algo) ||
+	    checked->value_len != info.checksum->checksum_len)
+		return -EAGAIN;
+
+	/* Check the signature with the key it would be made with now */
+	blob = malloc(FIT_KEY_BLOB_SIZE);
+	if (!blob)
+		return -ENOMEM;
+	ret = fdt_create_empty_tree(blob, FIT_KEY_BLOB_SIZE);
+	if (!ret)
+		ret = info.crypto->add_verify_data(&info, blob);
+	if (!ret) {
+		info.fdt_blob = blob;
+		info.required_keynode = -1;
+		ret = rsa_verify_hash(&info, checked->value, (uint8_t *)sig,
+				      sig_len);
+	}
+	free(blob);
+	if (ret) {
+		debug("Signature '%s' in '%s' does not verify, signing again\n",
+		      fit_get_name(fit, noffset, NULL), name);
+		return -EAGAIN;
+	}
+
+	if (!keydest)
+		return 0;
+	ret = info.crypto->add_verify_data(&info, keydest);
+	if (ret) {
+		printf("Failed to add verification data for '%s' signature node in '%s' node\n",
+		       fit_get_name(fit, noffset, NULL), name);
+	}
+
+	return ret;
+}
+
 /**
  * fit_image_process_sig- Process a single subnode of the images/ node
  *
@@ -290,6 +920,9 @@ static int fit_image_process_sig(const char *keydir, void *keydest,
  *
  * For signature details, please see doc/uImage.FIT/signature.txt
  *
+ * If fit_hash_prepare() found that the image is unchanged, its hash values
+ * are left as they are, as are any signatures which still verify.
+ *
  * @keydir	Directory containing *.key and *.crt files (or NULL)
  * @keydest	FDT Blob to write public keys into (NULL if none)
  * @fit:	Pointer to the FIT format image header
@@ -305,6 +938,7 @@ int fit_image_add_verification_data(const char *keydir, void *keydest,
 {
 	const char *image_name;
 	const void *data;
+	bool unchanged;
 	size_t size;
 	int noffset;
 
@@ -315,6 +949,7 @@ int fit_image_add_verification_data(const char *keydir, void *keydest,
 	}
 
 	image_name = fit_get_name(fit, image_noffset, NULL);
+	unchanged = fit_hash_image_unchanged(image_name, size);
 
 	/* Process all hash subnodes of the component image node */
 	for (noffset = fdt_first_subnode(fit, image_noffset);
@@ -331,14 +966,24 @@ int fit_image_add_verification_data(const char *keydir, void *keydest,
 		node_name = fit_get_name(fit, noffset, NULL);
 		if (!strncmp(node_name, FIT_HASH_NODENAME,
 			     strlen(FIT_HASH_NODENAME))) {
-			ret = fit_image_process_hash(fit, image_name, noffset,
-						data, size);
+			if (!unchanged)
+				ret = fit_image_process_hash(fit, image_name,
+						noffset, data, size);
 		} else if (IMAGE_ENABLE_SIGN && keydir &&
 			   !strncmp(node_name, FIT_SIG_NODENAME,
 				strlen(FIT_SIG_NODENAME))) {
-			ret = fit_image_process_sig(keydir, keydest,
-				fit, image_name, noffset, data, size,
-				comment, require_keys, engine_id, cmdname);
+			ret = -EAGAIN;
+			if (unchanged)
+				ret = fit_image_keep_sig(keydir, keydest, fit,
+					image_name, noffset,
+					require_keys ? "image" : NULL,
+					engine_id,
+					fit_hash_get_checked(image_name, size));
+			if (ret == -EAGAIN)
+				ret = fit_image_process_sig(keydir, keydest,
+					fit, image_name, noffset, data, size,
+					comment, require_keys, engine_id,
+					cmdname);
 		}
 		if (ret)
 			return ret;
@@ -576,10 +1221,80 @@ static int fit_config_get_data(void *fit, int conf_noffset, int noffset,
 	return 0;
 }
 
+/**
+ * struct fit_conf_sig - outcome of re-signing a configuration
+ *
+ * In incremental mode a configuration is signed again and the node is only
+ * updated if the signature or the list of hashed nodes differ. The outcome
+ * is kept until mkimage exits, since the FIT may be processed several times
+ * while making space for signatures, and the node may then already hold the
+ * new values.
+ *
+ * @conf_name:	Name of the configuration node
+ * @node_name:	Name of the signature node
+ * @changed:	true if the signature node must be updated
+ * @next:	Next entry in the list
+ */
+struct fit_conf_sig {
+	char *conf_name;
+	char *node_name;
+	bool changed;
+	struct fit_conf_sig *next;
+};
+
+static struct fit_conf_sig *fit_conf_sigs;
+
+/**
+ * fit_config_sig_changed() - check whether a configuration needs re-signing
+ *
+ * @fit:	FIT being processed
+ * @conf_name:	Name of the configuration node
+ * @noffset:	Offset of the signature node
+ * @value:	New signature value
+ * @value_len:	Length of @value
+ * @region_prop: New list of hashed nodes
+ * @region_proplen: Length of @region_prop
+ * @return true if the signature node must be updated
+ */
+static bool fit_config_sig_changed(const void *fit, const char *conf_name,
+		int noffset, const uint8_t *value, int value_len,
+		const char *region_prop, int region_proplen)
+{
+	const char *node_name = fit_get_name(fit, noffset, NULL);
+	struct fit_conf_sig *sig;
+	const void *prop;
+	int len;
+
+	for (sig = fit_conf_sigs; sig; sig = sig->next) {
+		if (!strcmp(sig->conf_name, conf_name) &&
+		    !strcmp(sig->node_name, node_name))
+			return sig->changed;
+	}
+
+	sig = calloc(1, sizeof(*sig));
+	if (!sig)
+		return true;
+	sig->conf_name = strdup(conf_name);
+	sig->node_name = strdup(node_name);
+	prop = fdt_getprop(fit, noffset, FIT_VALUE_PROP, &len);
+	sig->changed = !prop || len != value_len ||
+		memcmp(prop, value, len);
+	prop = fdt_getprop(fit, noffset, "hashed-nodes", &len);
+	if (!prop || len != region_proplen ||
+	    memcmp(prop, region_prop, len))
+		sig->changed = true;
+	sig->next = fit_conf_sigs;
+	fit_conf_sigs = sig;
+	debug("Configuration '%s' %s\n", conf_name,
+	      sig->changed ? "re-signed" : "is unchanged");
+
+	return sig->changed;
+}
+
 static int fit_config_process_sig(const char *keydir, void *keydest,
 		void *fit, const char *conf_name, int conf_noffset,
 		int noffset, const char *comment, int require_keys,
-		const char *engine_id, const char *cmdname)
+		const char *engine_id, const char *cmdname, bool incremental)
 {
 	struct image_sign_info info;
 	const char *node_name;
@@ -613,8 +1328,14 @@ static int fit_config_process_sig(const char *keydir, void *keydest,
 		return -1;
 	}
 
-	ret = fit_image_write_sig(fit, noffset, value, value_len, comment,
-				region_prop, region_proplen, cmdname);
+	if (incremental &&
+	    !fit_config_sig_changed(fit, conf_name, noffset, value, value_len,
+				    region_prop, region_proplen))
+		ret = 0;
+	else
+		ret = fit_image_write_sig(fit, noffset, value, value_len,
+					  comment, region_prop, region_proplen,
+					  cmdname);
 	if (ret) {
 		if (ret == -FDT_ERR_NOSPACE)
 			return -ENOSPC;
@@ -643,7 +1364,8 @@ static int fit_config_process_sig(const char *keydir, void *keydest,
 
 static int fit_config_add_verification_data(const char *keydir, void *keydest,
 		void *fit, int conf_noffset, const char *comment,
-		int require_keys, const char *engine_id, const char *cmdname)
+		int require_keys, const char *engine_id, const char *cmdname,
+		bool incremental)
 {
 	const char *conf_name;
 	int noffset;
@@ -662,7 +1384,7 @@ static int fit_config_add_verification_data(const char *keydir, void *keydest,
 			     strlen(FIT_SIG_NODENAME))) {
 			ret = fit_config_process_sig(keydir, keydest,
 				fit, conf_name, conf_noffset, noffset, comment,
-				require_keys, engine_id, cmdname);
+				require_keys, engine_id, cmdname, incremental);
 		}
 		if (ret)
 			return ret;
@@ -673,7 +1395,8 @@ static int fit_config_add_verification_data(const char *keydir, void *keydest,
 
 int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 			      const char *comment, int require_keys,
-			      const char *engine_id, const char *cmdname)
+			      const char *engine_id, const char *cmdname,
+			      bool incremental)
 {
 	int images_noffset, confs_noffset;
 	int noffset;
@@ -687,6 +1410,9 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 		return images_noffset;
 	}
 
+	/* Work out all the image hashes up front, in parallel */
+	fit_hash_prepare(fit, images_noffset, incremental);
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
@@ -721,7 +1447,8 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 		ret = fit_config_add_verification_data(keydir, keydest,
 						       fit, noffset, comment,
 						       require_keys,
-						       engine_id, cmdname);
+						       engine_id, cmdname,
+						       incremental);
 		if (ret)
 			return ret;
 	}
@@ -66,6 +66,7 @@ struct image_tool_params {
 	const char *keydest;	/* Destination .dtb for public key */
 	const char *comment;	/* Comment to add to signature node */
 	int require_keys;	/* 1 to mark signing keys as 'required' */
+	bool incremental;	/* Only update images/configs which changed */
 	int file_size;		/* Total size of output file */
 	int orig_file_size;	/* Original size for file before padding */
 	bool auto_its;		/* Automatically create the .its file */
@@ -77,6 +78,8 @@ struct image_tool_params {
 	bool quiet;		/* Don't output text in normal operation */
 	unsigned int external_offset;	/* Add padding to external data */
 	const char *engine_id;	/* Engine to use for signing */
+	bool data_crc_valid;	/* data_crc covers all data after the header */
+	uint32_t data_crc;	/* CRC32 of the data, updated while copying */
 };
 
 /*
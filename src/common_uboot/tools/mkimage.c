@@ -11,8 +11,10 @@
 #include "imximage.h"
 #include <image.h>
 #include <version.h>
+#include <u-boot/crc.h>
 
 static void copy_file(int, const char *, int);
+static void write_data(int ifd, const void *buf, int len);
 
 /* parameters initialized by core will be used by the image type code */
 static struct image_tool_params params = {
@@ -97,7 +99,7 @@ static void usage(const char *msg)
 		"          -i => input filename for ramdisk file\n");
 #ifdef CONFIG_FIT_SIGNATURE
 	fprintf(stderr,
-		"Signing / verified boot options: [-E] [-k keydir] [-K dtb] [ -c <comment>] [-p addr] [-r] [-N engine]\n"
+		"Signing / verified boot options: [-E] [-k keydir] [-K dtb] [ -c <comment>] [-p addr] [-r] [-u] [-N engine]\n"
 		"          -E => place data outside of the FIT structure\n"
 		"          -k => set directory containing private keys\n"
 		"          -K => write public keys to this .dtb file\n"
@@ -105,6 +107,7 @@ static void usage(const char *msg)
 		"          -F => re-sign existing FIT image\n"
 		"          -p => place external data at a static position\n"
 		"          -r => mark keys used as 'required' in dtb\n"
+		"          -u => with -F, only re-sign images and configurations which changed\n"
 		"          -N => engine to use for signing (pkcs11)\n");
 #else
 	fprintf(stderr,
@@ -143,7 +146,7 @@ static void process_args(int argc, char **argv)
 	int opt;
 
 	while ((opt = getopt(argc, argv,
-			     "a:A:b:c:C:d:D:e:Ef:Fk:i:K:ln:N:p:O:rR:qsT:vVx")) != -1) {
+			     "a:A:b:c:C:d:D:e:Ef:Fk:i:K:ln:N:p:O:rR:qsT:uvVx")) != -1) {
 		switch (opt) {
 		case 'a':
 			params.addr = strtoull(optarg, &ptr, 16);
@@ -269,6 +272,9 @@ static void process_args(int argc, char **argv)
 				usage("Invalid image type");
 			}
 			break;
+		case 'u':
+			params.incremental = true;
+			break;
 		case 'v':
 			params.vflag++;
 			break;
@@ -455,6 +461,14 @@ int main(int argc, char **argv)
 		exit (EXIT_FAILURE);
 	}
 
+	/*
+	 * The data CRC is worked out as the data is copied, so the header
+	 * can be filled in without reading the whole image back. Image types
+	 * which write the data themselves clear data_crc_valid.
+	 */
+	params.data_crc = 0;
+	params.data_crc_valid = !params.skipcpy;
+
 	if (!params.skipcpy) {
 		if (params.type == IH_TYPE_MULTI ||
 		    params.type == IH_TYPE_SCRIPT) {
@@ -479,12 +493,7 @@ int main(int argc, char **argv)
 					size = 0;
 				}
 
-				if (write(ifd, (char *)&size, sizeof(size)) != sizeof(size)) {
-					fprintf (stderr, "%s: Write error on %s: %s\n",
-						 params.cmdname, params.imagefile,
-						 strerror(errno));
-					exit (EXIT_FAILURE);
-				}
+				write_data(ifd, &size, sizeof(size));
 
 				if (!file) {
 					break;
@@ -514,11 +523,13 @@ int main(int argc, char **argv)
 			}
 		} else if (params.type == IH_TYPE_PBLIMAGE) {
 			/* PBL has special Image format, implements its' own */
+			params.data_crc_valid = false;
 			pbl_load_uboot(ifd, &params);
 		} else if (params.type == IH_TYPE_ZYNQMPBIF) {
 			/* Image file is meta, walk through actual targets */
 			int ret;
 
+			params.data_crc_valid = false;
 			ret = zynqmpbif_copy_image(ifd, &params);
 			if (ret)
 				return ret;
@@ -526,6 +537,7 @@ int main(int argc, char **argv)
 			copy_file(ifd, params.datafile, pad_len);
 		}
 		if (params.type == IH_TYPE_FIRMWARE_IVT) {
+			params.data_crc_valid = false;
 			/* Add alignment and IVT */
 			uint32_t aligned_filesize = (params.file_size + 0x1000
 					- 1) & ~(0x1000 - 1);
@@ -622,6 +634,18 @@ int main(int argc, char **argv)
 	exit (EXIT_SUCCESS);
 }
 
+/* Write image data, keeping the CRC of the data up to date */
+static void write_data(int ifd, const void *buf, int len)
+{
+	if (write(ifd, buf, len) != len) {
+		fprintf(stderr, "%s: Write error on %s: %s\n",
+			params.cmdname, params.imagefile, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	if (params.data_crc_valid)
+		params.data_crc = crc32(params.data_crc, buf, len);
+}
+
 static void
 copy_file (int ifd, const char *datafile, int pad)
 {
@@ -688,33 +712,18 @@ copy_file (int ifd, const char *datafile, int pad)
 	}
 
 	size = sbuf.st_size - offset;
-	if (write(ifd, ptr + offset, size) != size) {
-		fprintf (stderr, "%s: Write error on %s: %s\n",
-			params.cmdname, params.imagefile, strerror(errno));
-		exit (EXIT_FAILURE);
-	}
+	write_data(ifd, ptr + offset, size);
 
 	tail = size % 4;
 	if ((pad == 1) && (tail != 0)) {
-
-		if (write(ifd, (char *)&zero, 4-tail) != 4-tail) {
-			fprintf (stderr, "%s: Write error on %s: %s\n",
-				params.cmdname, params.imagefile,
-				strerror(errno));
-			exit (EXIT_FAILURE);
-		}
+		write_data(ifd, &zero, 4 - tail);
 	} else if (pad > 1) {
 		while (pad > 0) {
 			int todo = sizeof(zeros);
 
 			if (todo > pad)
 				todo = pad;
-			if (write(ifd, (char *)&zeros, todo) != todo) {
-				fprintf(stderr, "%s: Write error on %s: %s\n",
-					params.cmdname, params.imagefile,
-					strerror(errno));
-				exit(EXIT_FAILURE);
-			}
+			write_data(ifd, zeros, todo);
 			pad -= todo;
 		}
 	}
@@ -85,6 +85,8 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-flamegraph\tDump out call stacks with the time spent in\n"
+		"\t\t\teach, for flamegraph.pl\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
@@ -205,6 +207,23 @@ static struct func_info *find_caller_by_offset(uint32_t offset)
 	return low >= 0 ? &func_list[low] : NULL;
 }
 
+static int read_funcs(FILE *fin, int count)
+{
+	struct trace_output_func rec;
+	struct func_info *func;
+	int i;
+
+	notice("function count: %d\n", count);
+	for (i = 0; i < count; i++) {
+		if (read_data(fin, &rec, sizeof(rec)))
+			return 1;
+		func = find_func_by_offset(rec.offset);
+		if (func)
+			func->call_count = rec.call_count;
+	}
+	return 0;
+}
+
 static int read_calls(FILE *fin, int count)
 {
 	struct trace_call *call_data;
@@ -242,7 +261,8 @@ static int read_profile(FILE *fin, int *not_found)
 
 		switch (hdr.type) {
 		case TRACE_CHUNK_FUNCS:
-			/* Ignored at present */
+			if (read_funcs(fin, hdr.rec_count))
+				return 1;
 			break;
 
 		case TRACE_CHUNK_CALLS:
@@ -532,6 +552,221 @@ static int make_ftrace(void)
 	return 0;
 }
 
+/**
+ * struct flame_node - a call stack, with the time spent in it
+ *
+ * The nodes form a tree with a node for each distinct call stack seen in
+ * the trace.
+ *
+ * @func:	Function at the top of this stack, NULL for the root
+ * @parent:	Node for the caller's stack
+ * @child:	First node for a function called from this stack
+ * @next:	Next node with the same parent
+ * @self_us:	Time spent in @func itself, excluding its callees
+ */
+struct flame_node {
+	struct func_info *func;
+	struct flame_node *parent;
+	struct flame_node *child;
+	struct flame_node *next;
+	unsigned long self_us;
+};
+
+/**
+ * struct flame_frame - a function which is running at a point in the trace
+ *
+ * @node:	Call stack node for the function
+ * @entry:	Timestamp when the function was entered
+ * @child_us:	Time spent so far in functions it called
+ */
+struct flame_frame {
+	struct flame_node *node;
+	unsigned long entry;
+	unsigned long child_us;
+};
+
+static struct flame_node *flame_child(struct flame_node *node,
+				      struct func_info *func)
+{
+	struct flame_node *child;
+
+	for (child = node->child; child; child = child->next) {
+		if (child->func == func)
+			return child;
+	}
+	child = calloc(1, sizeof(*child));
+	assert(child);
+	child->func = func;
+	child->parent = node;
+	child->next = node->child;
+	node->child = child;
+
+	return child;
+}
+
+/* Timestamps are truncated, so work out differences modulo their width */
+static unsigned long flame_delta(unsigned long start, unsigned long end)
+{
+	return (end - start) & FUNCF_TIMESTAMP_MASK;
+}
+
+static void flame_exit(struct flame_frame *stack, int depth,
+		       unsigned long time)
+{
+	struct flame_frame *frame = &stack[depth];
+	unsigned long total = flame_delta(frame->entry, time);
+
+	frame->node->self_us += total > frame->child_us ?
+		total - frame->child_us : 0;
+	if (depth)
+		frame[-1].child_us += total;
+}
+
+static void flame_print(struct flame_node *node)
+{
+	struct flame_node *child;
+
+	if (node->self_us) {
+		struct flame_node *upto;
+		char buf[MAX_LINE_LEN * 8];
+		int len = sizeof(buf);
+
+		/* Build the stack backwards, from the leaf to the root */
+		buf[--len] = '\0';
+		for (upto = node; upto->func; upto = upto->parent) {
+			int size = strlen(upto->func->name);
+
+			if (len < size + 1)
+				break;
+			if (upto != node)
+				buf[--len] = ';';
+			len -= size;
+			memcpy(buf + len, upto->func->name, size);
+		}
+		printf("%s %lu\n", buf + len, node->self_us);
+	}
+	for (child = node->child; child; child = child->next)
+		flame_print(child);
+}
+
+/*
+ * Build the call stack tree from samples (see FUNCF_SAMPLE). Each sample is
+ * given the time until the next one.
+ */
+static void flame_add_samples(struct flame_node *root)
+{
+	struct flame_node *node = NULL;
+	struct trace_call *call;
+	unsigned long time, prev = 0;
+	int i;
+
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		struct func_info *func;
+
+		if (TRACE_CALL_TYPE(call) != FUNCF_SAMPLE)
+			continue;
+		time = call->flags & FUNCF_TIMESTAMP_MASK;
+
+		/* The outermost function starts a new sample */
+		if (!call->caller) {
+			if (node)
+				node->self_us += flame_delta(prev, time);
+			prev = time;
+			node = root;
+		}
+		if (!node)
+			continue;
+		func = find_func_by_offset(call->func);
+		if (func && (func->flags & FUNCF_TRACE))
+			node = flame_child(node, func);
+	}
+}
+
+/*
+ * Output one line for each call stack, giving the functions from the
+ * outermost one down, separated by ';', and the time in microseconds spent
+ * in the innermost function. This is the folded format which flamegraph.pl
+ * accepts, e.g.:
+ *
+ * board_init_r;initr_mmc;mmc_initialize;mmc_probe 1234
+ *
+ * If the trace was recorded in sampling mode, the samples are used instead
+ * of the function entry and exit records.
+ */
+static int make_flamegraph(void)
+{
+	struct flame_node root = { .func = NULL };
+	struct flame_frame *stack;
+	struct trace_call *call;
+	int max_depth = 256;
+	unsigned long time = 0;
+	int depth = -1;
+	int i;
+
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		if (TRACE_CALL_TYPE(call) == FUNCF_SAMPLE) {
+			flame_add_samples(&root);
+			flame_print(&root);
+			return 0;
+		}
+	}
+
+	stack = malloc(max_depth * sizeof(*stack));
+	assert(stack);
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		struct func_info *func = find_func_by_offset(call->func);
+		int d;
+
+		if (TRACE_CALL_TYPE(call) != FUNCF_ENTRY &&
+		    TRACE_CALL_TYPE(call) != FUNCF_EXIT)
+			continue;
+		if (!func || !(func->flags & FUNCF_TRACE))
+			continue;
+		time = call->flags & FUNCF_TIMESTAMP_MASK;
+
+		if (TRACE_CALL_TYPE(call) == FUNCF_ENTRY) {
+			struct flame_frame *frame;
+
+			if (depth + 1 == max_depth) {
+				max_depth *= 2;
+				stack = realloc(stack,
+						max_depth * sizeof(*stack));
+				assert(stack);
+			}
+			frame = &stack[++depth];
+			frame->node = flame_child(depth ? stack[depth - 1].node :
+						  &root, func);
+			frame->entry = time;
+			frame->child_us = 0;
+			continue;
+		}
+
+		/*
+		 * Records are dropped when the call depth is over the limit,
+		 * so an exit may not match the innermost function. Close any
+		 * functions down to the one which is exiting, or ignore the
+		 * exit if that function is not running.
+		 */
+		for (d = depth; d >= 0; d--) {
+			if (stack[d].node->func == func)
+				break;
+		}
+		if (d < 0)
+			continue;
+		for (; depth >= d; depth--)
+			flame_exit(stack, depth, time);
+	}
+
+	/* Close the functions still running at the end of the trace */
+	for (; depth >= 0; depth--)
+		flame_exit(stack, depth, time);
+	free(stack);
+
+	flame_print(&root);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -552,6 +787,8 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-flamegraph"))
+			err = make_flamegraph();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}